@@ -0,0 +1,115 @@
+#!/bin/sh
+# Benchmark of the supervisor and its generators, run by "make bench".
+# @author Vorobeva Aksinia 12044614
+# @date 11.12.2023
+#
+# First measures the IPC overhead of one solution with ringbench, then runs the supervisor with
+# BENCH_GENERATORS generators for BENCH_TIME seconds (after loading the graph) on random digraphs,
+# tournaments and planted near-DAGs of every size in BENCH_SIZES edges, once per generator mode in
+# BENCH_MODES. For every run it prints the candidates per second, the best size, the time it was found,
+# the best size at fixed points in time, and the gap to the optimum where it is known: planted graphs
+# know theirs, graphs of at most BENCH_EXACT_EDGES edges are solved with the exact mode first.
+# Last it runs a pool of BENCH_POOL_GENERATORS generators for BENCH_POOL_TIME seconds and prints how the
+# pool scaled: with more generators than CPUs it shrinks, and its probes start generators again.
+# The Makefile builds without optimization, "make bench CFLAGS='-O2 ...'" measures an optimized build.
+
+BENCH_GENERATORS=${BENCH_GENERATORS:-2}
+BENCH_TIME=${BENCH_TIME:-2}
+BENCH_SIZES=${BENCH_SIZES:-"10 100 1000 10000 100000 1000000"}
+BENCH_MODES=${BENCH_MODES:-"random local"}
+BENCH_EXACT_EDGES=${BENCH_EXACT_EDGES:-100}
+BENCH_EXACT_TIME=${BENCH_EXACT_TIME:-30}
+BENCH_SEED=${BENCH_SEED:-1}
+BENCH_POOL_GENERATORS=${BENCH_POOL_GENERATORS:-$(($(nproc) + 2))}
+BENCH_POOL_TIME=${BENCH_POOL_TIME:-30}
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+SUPERVISOR="$BENCH_DIR/../supervisor"
+GRAPHGEN="$BENCH_DIR/graphgen"
+RINGBENCH="$BENCH_DIR/ringbench"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+
+echo "== IPC overhead per solution (ringbench)"
+for producers in 1 "$BENCH_GENERATORS"; do
+	for records in 1 8; do
+		"$RINGBENCH" -p "$producers" -r "$records" -e 16 -b 50000 || exit 1
+	done
+done
+
+# vertices for a graph kind and a number of edges: out-degree 4, or a complete tournament
+vertices(){
+	case $1 in
+		tournament) awk -v m="$2" 'BEGIN{ n = int((1 + sqrt(1 + 8 * m)) / 2); print n < 2 ? 2 : n }' ;;
+		planted) awk -v m="$2" 'BEGIN{ n = int(m / 4); print n < 6 ? 6 : n }' ;;
+		*) awk -v m="$2" 'BEGIN{ n = int(m / 4); print n < 4 ? 4 : n }' ;;
+	esac
+}
+
+# best size of the exact mode, empty if it did not finish in time
+optimum(){
+	"$SUPERVISOR" -g 1 -m exact -f "$1" --time-limit "$BENCH_EXACT_TIME" 2>/dev/null | awk '
+		/acyclic!/ { print 0; exit }
+		/minimal solution removes/ { print $(NF - 1); exit }'
+}
+
+echo
+echo "== search: $BENCH_GENERATORS generators, ${BENCH_TIME}s per run"
+printf "%-10s %8s %8s %-7s %12s %8s %8s %6s %8s  %s\n" graph edges vertices mode candidates/s best optimum gap t_best "best at 0.1s/0.5s/1s/end"
+for kind in random tournament planted; do
+	for edges in $BENCH_SIZES; do
+		n=$(vertices "$kind" "$edges")
+		graph="$WORK/$kind-$edges"
+		format=""
+		[ "$edges" -ge 100000 ] && format="-b"
+		known=""
+		case $kind in
+			planted)
+				cycles=$((n / 10))
+				[ "$cycles" -lt 1 ] && cycles=1
+				"$GRAPHGEN" -t planted -n "$n" -m "$edges" -k "$cycles" -s "$BENCH_SEED" $format > "$graph" 2>/dev/null || exit 1
+				known=$cycles ;;
+			*)
+				"$GRAPHGEN" -t "$kind" -n "$n" -m "$edges" -s "$BENCH_SEED" $format > "$graph" || exit 1
+				[ "$edges" -le "$BENCH_EXACT_EDGES" ] && known=$(optimum "$graph") ;;
+		esac
+		for mode in $BENCH_MODES; do
+			"$SUPERVISOR" -g "$BENCH_GENERATORS" -m "$mode" -f "$graph" --time-limit "$BENCH_TIME" -v --stream \
+				> "$WORK/out" 2> "$WORK/err"
+			awk -v kind="$kind" -v edges="$edges" -v n="$n" -v mode="$mode" -v known="$known" -v end="$BENCH_TIME" '
+				FILENAME ~ /err$/ && /^\[/ {
+					t = substr($1, 2) + 0
+					candidates += $2 * (t - last)
+					last = t
+					next
+				}
+				FILENAME ~ /out$/ && $1 == "best" {
+					best = $2; t_best = $3
+					if($3 <= 0.1) at1 = $2
+					if($3 <= 0.5) at2 = $2
+					if($3 <= 1) at3 = $2
+					next
+				}
+				END {
+					rate = last > 0 ? candidates / last : 0
+					if(best == "") { best = "-"; t_best = "-" }
+					gap = (known != "" && best != "-") ? best - known : "-"
+					printf "%-10s %8d %8d %-7s %12.0f %8s %8s %6s %8s  %s/%s/%s/%s\n", kind, edges, n, mode, rate,
+						best, known == "" ? "-" : known, gap, t_best, at1 == "" ? "-" : at1, at2 == "" ? "-" : at2,
+						at3 == "" ? "-" : at3, best
+				}' "$WORK/err" "$WORK/out"
+		done
+		rm -f "$graph"
+	done
+done
+
+echo
+echo "== pool scaling: $BENCH_POOL_GENERATORS generators on $(nproc) CPUs, ${BENCH_POOL_TIME}s"
+graph="$WORK/pool"
+"$GRAPHGEN" -t random -n 2000 -m 8000 -s "$BENCH_SEED" > "$graph" || exit 1
+"$SUPERVISOR" -g "$BENCH_POOL_GENERATORS" -m local -f "$graph" --time-limit "$BENCH_POOL_TIME" -v \
+	2>&1 >/dev/null | awk '
+		/ pool shrinks / { shrinks++ }
+		/ pool grows / { grows++ }
+		/ pool (grows|shrinks) / { sub(/^[^:]*: /, ""); print "  " $0 }
+		END { printf "  %d generators stopped, %d started again\n", shrinks, grows }'
@@ -0,0 +1,233 @@
+/**
+ * @file graphgen.c
+ * @brief generates benchmark graphs for the supervisor: random digraphs, tournaments and
+ * near-acyclic graphs with planted cycles whose minimal feedback arc set is known.
+ * @details The graph is written to stdout, as "start-end" words or with -b in the binary format of
+ * graph.h. Planted graphs are a random DAG along a hidden vertex order with k vertex-disjoint
+ * cycles added: k disjoint cycles need k removed edges and removing their k back edges leaves the
+ * DAG, so the minimal feedback arc set has exactly k edges.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "../common.h"
+#include "../graph.h"
+#include "../rng.h"
+
+#define PLANTED_CYCLE 3
+
+char *prog_name;
+
+/**
+ * @brief Kind of graph that is generated.
+ */
+typedef enum{
+	KIND_RANDOM,		///< m edges between random pairs of different vertices.
+	KIND_TOURNAMENT,	///< One edge of random direction between every pair of vertices.
+	KIND_PLANTED		///< Random DAG with k planted vertex-disjoint cycles.
+} kind_t;
+
+/**
+ * @struct graphgen_t
+ * @brief Structure to represent the parameters of the generated graph.
+ */
+typedef struct{
+	kind_t kind;
+	int vertices;
+	int edges;
+	int cycles;
+	uint64_t seed;
+	bool binary;
+} graphgen_t;
+
+graphgen_t graphgen;
+rng_t rng;
+
+/**
+ * @brief Reads a non-negative integer from the command-line option argument.
+ */
+static int readCountOptarg(void){
+	char *ptr;
+	long int ret = strtol(optarg, &ptr, 10);
+	if(*ptr != '\0' || ret < 0 || ret > INT_MAX)
+		printErrorAndExit(prog_name, "number is invalid");
+	return (int) ret;
+}
+
+/**
+ * @brief Parses the options: '-t random|tournament|planted', '-n vertices', '-m edges' (not for
+ * tournaments), '-k cycles' (planted graphs), '-s seed' and '-b' for the binary format.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @param graphgen A pointer to the graphgen_t structure to store the parsed parameters.
+ */
+void getArgumentsSetGraphgen(int argc, char *argv[], graphgen_t *graphgen){
+	int opt;
+	graphgen->kind = KIND_RANDOM;
+	graphgen->vertices = 0;
+	graphgen->edges = 0;
+	graphgen->cycles = 1;
+	graphgen->seed = 1;
+	graphgen->binary = false;
+	while((opt = getopt(argc, argv, "t:n:m:k:s:b")) != -1){
+		switch(opt){
+			case 't':{
+				if(strcmp(optarg, "random") == 0)
+					graphgen->kind = KIND_RANDOM;
+				else if(strcmp(optarg, "tournament") == 0)
+					graphgen->kind = KIND_TOURNAMENT;
+				else if(strcmp(optarg, "planted") == 0)
+					graphgen->kind = KIND_PLANTED;
+				else
+					printErrorAndExit(prog_name, "type is invalid (random, tournament, planted)");
+				break;
+			}
+			case 'n':
+				graphgen->vertices = readCountOptarg();
+				break;
+			case 'm':
+				graphgen->edges = readCountOptarg();
+				break;
+			case 'k':
+				graphgen->cycles = readCountOptarg();
+				break;
+			case 's':
+				graphgen->seed = (uint64_t) readCountOptarg();
+				break;
+			case 'b':
+				graphgen->binary = true;
+				break;
+			default:
+				printErrorAndExit(prog_name, "usage: graphgen -t type -n vertices [-m edges] [-k cycles] [-s seed] [-b]");
+		}
+	}
+	if(graphgen->vertices < 2)
+		printErrorAndExit(prog_name, "at least two vertices are required");
+	if(graphgen->kind == KIND_TOURNAMENT)
+		graphgen->edges = (int)((int64_t) graphgen->vertices * (graphgen->vertices - 1) / 2);
+	if(graphgen->kind == KIND_PLANTED && (int64_t) graphgen->cycles * PLANTED_CYCLE > graphgen->vertices)
+		printErrorAndExit(prog_name, "too many cycles for the vertices");
+	if(graphgen->kind == KIND_PLANTED && graphgen->edges < graphgen->cycles * PLANTED_CYCLE)
+		graphgen->edges = graphgen->cycles * PLANTED_CYCLE;
+	if(graphgen->edges < 1)
+		printErrorAndExit(prog_name, "at least one edge is required");
+}
+
+/**
+ * @brief Returns a random vertex other than v.
+ */
+static int otherVertex(int v){
+	int u = (int) rngBounded(&rng, (uint32_t) graphgen.vertices - 1);
+	return u >= v ? u + 1 : u;
+}
+
+/**
+ * @brief Fills the edges of the graph.
+ *
+ * @details The edges of a planted graph are shuffled, so the planted cycles are not at the start
+ * of the list.
+ *
+ * @param edges The list of edges, with room for graphgen.edges edges.
+ */
+void generateEdges(list_of_edges_t *edges){
+	int n = graphgen.vertices;
+	int m = 0;
+	switch(graphgen.kind){
+		case KIND_RANDOM:
+			for(; m < graphgen.edges; m++){
+				edges->list[m].start = (int) rngBounded(&rng, (uint32_t) n);
+				edges->list[m].end = otherVertex(edges->list[m].start);
+			}
+			break;
+		case KIND_TOURNAMENT:
+			for(int u = 0; u < n; u++){
+				for(int v = u + 1; v < n; v++, m++){
+					bool forward = rngNext(&rng) & 1;
+					edges->list[m].start = forward ? u : v;
+					edges->list[m].end = forward ? v : u;
+				}
+			}
+			break;
+		case KIND_PLANTED:{
+			int *order = malloc((size_t) n * sizeof(int));
+			if(order == NULL)
+				printErrorAndExit(prog_name, "malloc of hidden order is failed");
+			for(int i = 0; i < n; i++)
+				order[i] = i;
+			for(int i = n - 1; i > 0; i--){
+				int j = (int) rngBounded(&rng, (uint32_t) i + 1);
+				int tmp = order[i];
+				order[i] = order[j];
+				order[j] = tmp;
+			}
+			for(int c = 0; c < graphgen.cycles; c++){
+				int first = c * PLANTED_CYCLE;
+				for(int i = 0; i < PLANTED_CYCLE; i++, m++){
+					edges->list[m].start = order[first + i];
+					edges->list[m].end = order[first + (i + 1) % PLANTED_CYCLE];
+				}
+			}
+			for(; m < graphgen.edges; m++){
+				int a = (int) rngBounded(&rng, (uint32_t) n);
+				int b = otherVertex(a);
+				edges->list[m].start = order[a < b ? a : b];
+				edges->list[m].end = order[a < b ? b : a];
+			}
+			free(order);
+			for(int i = m - 1; i > 0; i--){
+				int j = (int) rngBounded(&rng, (uint32_t) i + 1);
+				edge_t tmp = edges->list[i];
+				edges->list[i] = edges->list[j];
+				edges->list[j] = tmp;
+			}
+			break;
+		}
+	}
+	edges->size = m;
+}
+
+/**
+ * @brief Writes the edges to stdout, in the binary format of graph.h or as "start-end" words.
+ *
+ * @param edges The list of edges.
+ */
+void writeEdges(const list_of_edges_t *edges){
+	if(graphgen.binary){
+		int32_t amount = edges->size;
+		if(fwrite(GRAPH_MAGIC, 1, GRAPH_MAGIC_SIZE, stdout) != GRAPH_MAGIC_SIZE
+				|| fwrite(&amount, sizeof(amount), 1, stdout) != 1
+				|| fwrite(edges->list, sizeof(edge_t), (size_t) edges->size, stdout) != (size_t) edges->size)
+			printErrorAndExit(prog_name, "fwrite is failed");
+	}
+	else{
+		for(int i = 0; i < edges->size; i++)
+			fprintf(stdout, "%d-%d%c", edges->list[i].start, edges->list[i].end, i + 1 < edges->size ? ' ' : '\n');
+	}
+	if(fflush(stdout) == EOF)
+		printErrorAndExit(prog_name, "fflush is failed");
+}
+
+/**
+ * @brief The main function of the program.
+ *
+ * @details Parses the options, seeds the rng, generates the graph and writes it to stdout. The
+ * minimal feedback arc set of a planted graph, the number of cycles, is written to stderr.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @return The exit status of the program.
+ */
+int main(int argc, char *argv[]){
+	prog_name = argv[0];
+	getArgumentsSetGraphgen(argc, argv, &graphgen);
+	rngSeed(&rng, graphgen.seed);
+	list_of_edges_t *edges = malloc(LIST_OF_EDGES_SIZE(graphgen.edges));
+	if(edges == NULL)
+		printErrorAndExit(prog_name, "malloc of edges is failed");
+	generateEdges(edges);
+	writeEdges(edges);
+	if(graphgen.kind == KIND_PLANTED)
+		fprintf(stderr, "optimum %d\n", graphgen.cycles);
+	free(edges);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file ringbench.c
+ * @brief measures the cost of passing solutions from generators to the supervisor through the ring
+ * @details Forks producers that publish batches of records as fast as they can while the parent
+ * reads them like the supervisor does, so the time per record is the IPC overhead of one solution
+ * without any search. The ring lives in an anonymous shared mapping, no shared memory object is
+ * created.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "../common.h"
+#include "../ring.h"
+#include <sys/wait.h>
+#include <time.h>
+
+#define READ_TIMEOUT_MS 100
+
+char *prog_name;
+
+/**
+ * @struct ringbench_t
+ * @brief Structure to represent the parameters of the measurement.
+ */
+typedef struct{
+	int producers;		///< Number of producer processes.
+	int batches;		///< Number of batches every producer publishes.
+	int records;		///< Number of records per batch.
+	int indices;		///< Number of edge indices per record.
+} ringbench_t;
+
+ringbench_t ringbench;
+
+/**
+ * @brief Reads a positive integer from the command-line option argument.
+ */
+static int readPositiveOptarg(void){
+	char *ptr;
+	long int ret = strtol(optarg, &ptr, 10);
+	if(*ptr != '\0' || ret <= 0 || ret > INT_MAX)
+		printErrorAndExit(prog_name, "number is invalid");
+	return (int) ret;
+}
+
+/**
+ * @brief Parses the options '-p producers', '-b batches per producer', '-r records per batch' and
+ * '-e edge indices per record'.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @param ringbench A pointer to the ringbench_t structure to store the parsed parameters.
+ */
+void getArgumentsSetRingbench(int argc, char *argv[], ringbench_t *ringbench){
+	int opt;
+	ringbench->producers = 1;
+	ringbench->batches = 100000;
+	ringbench->records = 1;
+	ringbench->indices = 16;
+	while((opt = getopt(argc, argv, "p:b:r:e:")) != -1){
+		switch(opt){
+			case 'p':
+				ringbench->producers = readPositiveOptarg();
+				break;
+			case 'b':
+				ringbench->batches = readPositiveOptarg();
+				break;
+			case 'r':
+				ringbench->records = readPositiveOptarg();
+				break;
+			case 'e':
+				ringbench->indices = readPositiveOptarg();
+				break;
+			default:
+				printErrorAndExit(prog_name, "usage: ringbench [-p producers] [-b batches] [-r records] [-e indices]");
+		}
+	}
+	if(ringbench->producers > MAX_PRODUCERS)
+		printErrorAndExit(prog_name, "too many producers");
+}
+
+/**
+ * @brief Publishes the batches of one producer and exits.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+static void produce(myshm_t *myshm){
+	producer_stats_t *stats = ringRegister(myshm);
+	for(int b = 0; b < ringbench.batches; b++){
+		unsigned ticket;
+		batch_t *slot = ringReserve(myshm, &ticket, stats);
+		if(slot == NULL)
+			break;
+		slot->producer = (int) getpid();
+		slot->records = ringbench.records;
+		slot->used = 0;
+		for(int r = 0; r < ringbench.records; r++){
+			int *record = slot->data + slot->used;
+			record[0] = ringbench.indices;
+			record[1] = ringbench.indices;
+			for(int i = 0; i < ringbench.indices; i++)
+				record[2 + i] = i;
+			slot->used += RECORD_INTS(ringbench.indices);
+		}
+		ringPublish(myshm, ticket);
+	}
+	_exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief The main function of the program.
+ *
+ * @details Maps the ring, forks the producers and reads every batch, touching every record like
+ * the supervisor. Prints the batches and records per second, the time per record and the share of
+ * time the producers waited on a full ring and the reader waited on an empty ring.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @return The exit status of the program.
+ */
+int main(int argc, char *argv[]){
+	prog_name = argv[0];
+	getArgumentsSetRingbench(argc, argv, &ringbench);
+	int batch_capacity = ringbench.records * RECORD_INTS(ringbench.indices);
+	size_t shm_size = SHM_SIZE(batch_capacity);
+	myshm_t *myshm = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(myshm == MAP_FAILED)
+		printErrorAndExit(prog_name, "mmap is failed");
+	myshm->batch_capacity = batch_capacity;
+	ringInit(myshm);
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int p = 0; p < ringbench.producers; p++){
+		pid_t pid = fork();
+		if(pid == -1)
+			printErrorAndExit(prog_name, "fork is failed");
+		if(pid == 0)
+			produce(myshm);
+	}
+	uint64_t total = (uint64_t) ringbench.producers * (uint64_t) ringbench.batches;
+	uint64_t checksum = 0;
+	for(uint64_t read = 0; read < total; ){
+		batch_t *batch = ringPeek(myshm, READ_TIMEOUT_MS);
+		if(batch == NULL)
+			continue;
+		int offset = 0;
+		for(int r = 0; r < batch->records; r++){
+			checksum += (uint64_t) batch->data[offset];
+			offset += RECORD_INTS(batch->data[offset + 1]);
+		}
+		ringRelease(myshm);
+		read++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	uint64_t producer_wait = 0;
+	for(int i = 0; i < MAX_PRODUCERS; i++)
+		producer_wait += myshm->producers[i].wait_ns;
+	ringStop(myshm);
+	while(wait(NULL) > 0)
+		;
+
+	double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+	double records = (double) total * ringbench.records;
+	fprintf(stdout, "producers %d, %d records of %d indices per batch: %.0f batches/s, %.0f records/s, "
+			"%.1f ns/record, producers wait %.0f%%, reader waits %.0f%%\n",
+			ringbench.producers, ringbench.records, ringbench.indices, total / seconds, records / seconds,
+			seconds * 1e9 / records, producer_wait / 1e7 / seconds / ringbench.producers,
+			myshm->consumer_wait_ns / 1e7 / seconds);
+	if(checksum != (uint64_t) records * (uint64_t) ringbench.indices)
+		printErrorAndExit(prog_name, "records were lost");
+	munmap(myshm, shm_size);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/*
+ * @file checkpoint.c
+ * @brief saving the best vertex order and removed edges to a file, and seeding a search from it
+ * @details A checkpoint is a text file: the header line, "size" with the number of removed edges,
+ * "order" with the original vertices in the order and "edges" with the removed edges as
+ * "start-end" words. The supervisor only receives the removed edges, so the order is a topological
+ * order of the graph without them, computed with Kahn's algorithm; its backward edges are a subset
+ * of the removed edges. A generator maps the vertices of the order by their original ids, so the
+ * checkpoint of an earlier, slightly different graph still seeds the search: vertices that are
+ * gone are skipped, new vertices are appended and edges that were added or removed are simply
+ * evaluated against the order.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "checkpoint.h"
+
+extern char *prog_name;
+
+/**
+ * @brief Computes a topological order of the graph without the removed edges and without self-loops.
+ *
+ * @details Vertices on a cycle that is left, which only happens if the removed edges are not a
+ * feedback arc set, are appended in the order of their ids.
+ *
+ * @return A newly allocated order of the vertices, NULL if the memory is exhausted.
+ */
+static int *topologicalOrder(const graph_t *graph, const int *removed, int size){
+	int n = graph->vertices_amount;
+	int m = graph->edges_amount;
+	bool *skip = calloc((size_t) m + 1, sizeof(bool));
+	int *in_degree = calloc((size_t) n + 1, sizeof(int));
+	int *offsets = calloc((size_t) n + 2, sizeof(int));
+	int *targets = malloc(((size_t) m + 1) * sizeof(int));
+	int *order = malloc(((size_t) n + 1) * sizeof(int));
+	if(skip == NULL || in_degree == NULL || offsets == NULL || targets == NULL || order == NULL){
+		free(skip);
+		free(in_degree);
+		free(offsets);
+		free(targets);
+		free(order);
+		return NULL;
+	}
+	for(int i = 0; i < size; i++)
+		if(removed[i] >= 0 && removed[i] < m)
+			skip[removed[i]] = true;
+	for(int i = 0; i < m; i++){
+		if(skip[i] || graph->edge_starts[i] == graph->edge_ends[i])
+			continue;
+		offsets[graph->edge_starts[i] + 2]++;
+		in_degree[graph->edge_ends[i]]++;
+	}
+	for(int v = 0; v < n; v++)
+		offsets[v + 2] += offsets[v + 1];
+	for(int i = 0; i < m; i++)
+		if(!skip[i] && graph->edge_starts[i] != graph->edge_ends[i])
+			targets[offsets[graph->edge_starts[i] + 1]++] = graph->edge_ends[i];
+
+	int head = 0;
+	int tail = 0;
+	for(int v = 0; v < n; v++)
+		if(in_degree[v] == 0)
+			order[tail++] = v;
+	while(head < tail){
+		int v = order[head++];
+		for(int k = offsets[v]; k < offsets[v + 1]; k++)
+			if(--in_degree[targets[k]] == 0)
+				order[tail++] = targets[k];
+	}
+	for(int v = 0; v < n && tail < n; v++)
+		if(in_degree[v] > 0)
+			order[tail++] = v;
+	free(skip);
+	free(in_degree);
+	free(offsets);
+	free(targets);
+	return order;
+}
+
+/**
+ * @brief Writes a checkpoint of a solution.
+ *
+ * @details The checkpoint is written to path.tmp and renamed to path, so a generator that reads
+ * the checkpoint never sees a partial file.
+ *
+ * @param path The path of the checkpoint file, it is replaced atomically.
+ * @param graph The graph created with createGraph from the supervisor's list of edges.
+ * @param removed The indices of the removed edges in the list of edges.
+ * @param size Number of removed edges.
+ * @return true if the checkpoint was written, false otherwise.
+ */
+bool checkpointSave(const char *path, const graph_t *graph, const int *removed, int size){
+	int *order = topologicalOrder(graph, removed, size);
+	char *temporary = malloc(strlen(path) + sizeof(".tmp"));
+	if(order == NULL || temporary == NULL){
+		free(order);
+		free(temporary);
+		return false;
+	}
+	strcpy(temporary, path);
+	strcat(temporary, ".tmp");
+	FILE *file = fopen(temporary, "w");
+	bool written = file != NULL;
+	if(written){
+		fprintf(file, "%s\nsize %d\norder", CHECKPOINT_HEADER, size);
+		for(int i = 0; i < graph->vertices_amount; i++)
+			fprintf(file, " %d", graph->vertex_ids[order[i]]);
+		fprintf(file, "\nedges");
+		for(int i = 0; i < size; i++)
+			fprintf(file, " %d-%d", graph->vertex_ids[graph->edge_starts[removed[i]]],
+					graph->vertex_ids[graph->edge_ends[removed[i]]]);
+		fprintf(file, "\n");
+		written = !ferror(file);
+		written = fclose(file) == 0 && written;
+		written = written && rename(temporary, path) == 0;
+		if(!written)
+			remove(temporary);
+	}
+	free(order);
+	free(temporary);
+	return written;
+}
+
+/**
+ * @brief Compares two (original id, dense id) pairs by the original id.
+ */
+static int comparePairs(const void *a, const void *b){
+	int x = ((const int *) a)[0];
+	int y = ((const int *) b)[0];
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Replaces an order with the order of a checkpoint.
+ *
+ * @details The original ids of the checkpoint are looked up with a binary search in the sorted
+ * original ids of the graph. Ids the graph does not have and repeated ids are skipped, vertices the
+ * checkpoint does not have follow the mapped ones in the order of their dense ids.
+ *
+ * @param path The path of the checkpoint file.
+ * @param graph The graph whose vertices are ordered.
+ * @param order Receives the vertex at every position.
+ * @param position Receives the position of every vertex.
+ * @return true if the checkpoint was read, false if it is missing or invalid.
+ */
+bool checkpointSeed(const char *path, const graph_t *graph, int *order, int *position){
+	FILE *file = fopen(path, "r");
+	if(file == NULL)
+		return false;
+	char header[sizeof(CHECKPOINT_HEADER) + 1];
+	int size;
+	int matched = 0;
+	bool valid = fgets(header, sizeof(header), file) != NULL
+		&& strncmp(header, CHECKPOINT_HEADER, sizeof(CHECKPOINT_HEADER) - 1) == 0
+		&& fscanf(file, " size %d order%n", &size, &matched) == 1 && matched > 0;
+	int n = graph->vertices_amount;
+	int *pairs = malloc((2 * (size_t) n + 1) * sizeof(int));
+	if(!valid || pairs == NULL){
+		free(pairs);
+		fclose(file);
+		return false;
+	}
+	for(int v = 0; v < n; v++){
+		pairs[2 * v] = graph->vertex_ids[v];
+		pairs[2 * v + 1] = v;
+	}
+	qsort(pairs, (size_t) n, 2 * sizeof(int), comparePairs);
+	for(int v = 0; v < n; v++)
+		position[v] = -1;
+
+	int placed = 0;
+	int id;
+	while(placed < n && fscanf(file, "%d", &id) == 1){
+		int key[2] = {id, 0};
+		int *pair = bsearch(key, pairs, (size_t) n, 2 * sizeof(int), comparePairs);
+		if(pair != NULL && position[pair[1]] == -1){
+			position[pair[1]] = placed;
+			order[placed++] = pair[1];
+		}
+	}
+	for(int v = 0; v < n; v++){
+		if(position[v] == -1){
+			position[v] = placed;
+			order[placed++] = v;
+		}
+	}
+	free(pairs);
+	fclose(file);
+	return true;
+}
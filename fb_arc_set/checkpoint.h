@@ -0,0 +1,39 @@
+/*
+ * @file checkpoint.h
+ * @brief saving the best vertex order and removed edges to a file, and seeding a search from it
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef CHECKPOINT
+#define CHECKPOINT
+
+#include "graph.h"
+
+/**
+ * @brief First line of a checkpoint file.
+ */
+#define CHECKPOINT_HEADER "fb_arc_set checkpoint"
+
+/**
+ * @brief Writes a checkpoint of a solution.
+ *
+ * @param path The path of the checkpoint file, it is replaced atomically.
+ * @param graph The graph created with createGraph from the supervisor's list of edges.
+ * @param removed The indices of the removed edges in the list of edges.
+ * @param size Number of removed edges.
+ * @return true if the checkpoint was written, false otherwise.
+ */
+bool checkpointSave(const char *path, const graph_t *graph, const int *removed, int size);
+
+/**
+ * @brief Replaces an order with the order of a checkpoint.
+ *
+ * @param path The path of the checkpoint file.
+ * @param graph The graph whose vertices are ordered.
+ * @param order Receives the vertex at every position.
+ * @param position Receives the position of every vertex.
+ * @return true if the checkpoint was read, false if it is missing or invalid.
+ */
+bool checkpointSeed(const char *path, const graph_t *graph, int *order, int *position);
+
+#endif
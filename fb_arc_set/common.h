@@ -12,16 +12,25 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
-#include <semaphore.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <errno.h>
+#include <signal.h>
 
-#define DEFAULT_EDGES_AMOUNT 40
-#define BUFFER_SIZE 12
+#define BUFFER_SIZE 16
+#define CANDIDATE_FLUSH 256
+#define BATCH_INTS 1024
+#define BATCH_DELAY_MS 10
+#define MAX_PRODUCERS 64
 
+/**
+ * @brief Prefixes of the shared memory objects, an instance appends "." and its id, see instance.h.
+ */
 #define SHM_NAME "/myshm"
+#define SHM_GRAPH_NAME "/myshm_graph"
 
 /**
  * @brief Structure representing an edge between two vertices.
@@ -33,22 +42,147 @@ typedef struct{
 
 /**
  * @brief Structure representing a list of edges.
+ * @details The list is allocated with room for as many edges as needed, see LIST_OF_EDGES_SIZE.
  */
 typedef struct{
-	edge_t list[DEFAULT_EDGES_AMOUNT];
 	int size;
+	edge_t list[];
 } list_of_edges_t;
 
+/**
+ * @brief Structure representing a batch of solution records, the content of one ring slot.
+ * @details data holds the records one after another. A record is the size of a solution, the
+ * number of edge indices that follow and the indices of the removed edges in the supervisor's
+ * list of edges. The list is optional: a record without indices only reports a size, which is
+ * what a record becomes when a later record of the same batch is better.
+ */
+typedef struct{
+	int producer;	///< Process id of the generator that published the batch.
+	int records;	///< Number of records in the batch.
+	int used;	///< Number of integers of data taken by the records.
+	int data[];
+} batch_t;
+
+/**
+ * @brief Telemetry of one generator in the shared memory, written by the generator and read by the supervisor.
+ */
+typedef struct{
+	int pid;		///< Process id of the generator, 0 if the entry is free.
+	uint64_t candidates;	///< Number of candidates the generator evaluated.
+	uint64_t wait_ns;	///< Nanoseconds the generator was blocked on a full ring.
+	uint64_t batches;	///< Number of batches the generator published.
+} producer_stats_t;
+
 /**
  * @brief Structure representing shared memory data.
+ * @details The header is followed by BUFFER_SIZE slots of SLOT_INTS(batch_capacity) integers each.
+ * Every slot starts with its sequence number and the process id of the generator that reserved it,
+ * followed by a batch_t. The supervisor sets
+ * batch_capacity so that a record of every edge of the graph fits, because a solution never removes
+ * more edges than the graph has. Generators only record solutions that lower best_bound, publish
+ * their batch before they add the number of candidates they evaluated to candidates every
+ * CANDIDATE_FLUSH candidates, which is what the supervisor's limit counts. The indices are free
+ * running counters, BUFFER_SIZE must be a power of two so they stay consistent when they wrap around.
+ * See ring.c for the protocol.
  */
 typedef struct{
-	list_of_edges_t buffer[BUFFER_SIZE];
-	int read_index;
-	int write_index;
-	bool stop;	
+	unsigned read_index;		///< Next position the supervisor reads, only written by the supervisor.
+	unsigned write_index;		///< Next position a generator reserves, incremented atomically.
+	unsigned used_futex;		///< Incremented whenever a slot is published.
+	unsigned free_futex;		///< Incremented whenever a slot is released.
+	int consumer_waiting;		///< Non zero while the supervisor sleeps on used_futex.
+	int producers_waiting;		///< Number of generators sleeping on free_futex.
+	bool stop;
+	bool optimal;			///< Set by a generator after it published a solution that is proven minimal.
+	int batch_capacity;		///< Number of integers of data a batch can hold.
+	int best_bound;			///< Size of the best solution published so far, only ever lowered.
+	int owner;			///< Process id of the supervisor that created the shared memory.
+	uint64_t candidates;		///< Number of candidates evaluated by all generators.
+	uint64_t consumer_wait_ns;	///< Nanoseconds the supervisor was blocked on an empty ring.
+	producer_stats_t producers[MAX_PRODUCERS];	///< Telemetry of the generators, see ringRegister.
+	int slots[];
 }myshm_t;
 
+/**
+ * @brief Flags a long search polls, it returns early once one of them is set.
+ * @details A generator sets ring to the stop flag of the ring and signal to its own quit flag, so both
+ * the supervisor stopping the ring and a SIGTERM end the search. Either may be NULL.
+ */
+typedef struct{
+	const bool *ring;			///< Stop flag of the ring, set by the supervisor.
+	const volatile sig_atomic_t *signal;	///< Quit flag of the process, set by its signal handler.
+} stop_t;
+
+/**
+ * @brief Returns whether a search was asked to stop.
+ *
+ * @param stop The flags of the search.
+ * @return true if one of the flags is set.
+ */
+static inline bool stopRequested(const stop_t *stop){
+	return (stop->ring != NULL && __atomic_load_n(stop->ring, __ATOMIC_RELAXED))
+		|| (stop->signal != NULL && *stop->signal);
+}
+
+/**
+ * @brief Size in bytes of a list_of_edges_t that can hold capacity edges.
+ */
+#define LIST_OF_EDGES_SIZE(capacity) (sizeof(list_of_edges_t) + (size_t)(capacity) * sizeof(edge_t))
+
+/**
+ * @brief Number of integers of a record with count edge indices.
+ */
+#define RECORD_INTS(count) (2 + (count))
+
+/**
+ * @brief Size in bytes of a batch_t whose records take used integers.
+ */
+#define BATCH_SIZE(used) (sizeof(batch_t) + (size_t)(used) * sizeof(int))
+
+/**
+ * @brief Number of integers of one ring slot whose batch holds capacity integers, including its sequence number
+ * and its reserver.
+ */
+#define SLOT_INTS(capacity) (2 + (BATCH_SIZE(capacity) + sizeof(int) - 1) / sizeof(int))
+
+/**
+ * @brief Size in bytes of the shared memory for ring slots whose batches hold capacity integers.
+ */
+#define SHM_SIZE(capacity) (sizeof(myshm_t) + BUFFER_SIZE * SLOT_INTS(capacity) * sizeof(int))
+
+/**
+ * @brief Returns the ring slot with the given index.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param index The index of the slot, between 0 and BUFFER_SIZE - 1.
+ * @return A pointer to the batch stored in the slot.
+ */
+static inline batch_t *getSlot(myshm_t *myshm, unsigned index){
+	return (batch_t *)(myshm->slots + (size_t)index * SLOT_INTS(myshm->batch_capacity) + 2);
+}
+
+/**
+ * @brief Returns the sequence number of the ring slot with the given index.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param index The index of the slot, between 0 and BUFFER_SIZE - 1.
+ * @return A pointer to the sequence number of the slot.
+ */
+static inline unsigned *getSlotSequence(myshm_t *myshm, unsigned index){
+	return (unsigned *)(myshm->slots + (size_t)index * SLOT_INTS(myshm->batch_capacity));
+}
+
+/**
+ * @brief Returns the process id of the generator that reserved the ring slot with the given index.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param index The index of the slot, between 0 and BUFFER_SIZE - 1.
+ * @return A pointer to the process id, 0 while the slot is free or the reserver has not written it yet.
+ */
+static inline int *getSlotReserver(myshm_t *myshm, unsigned index){
+	return myshm->slots + (size_t)index * SLOT_INTS(myshm->batch_capacity) + 1;
+}
+
 /**
  * @brief Macro for printing an error message and exiting the program.
  *
@@ -0,0 +1,420 @@
+/*
+ * @file exact.c
+ * @brief exact minimal feedback arc set of a strongly connected component
+ * @details A vertex order is built from the front. When a vertex is appended, its edges coming
+ * from vertices that are not placed yet become backward edges, and that number only depends on
+ * the set of placed vertices. Small components are therefore solved by dynamic programming over
+ * all subsets of their vertices. Larger components are solved by branch and bound over the order:
+ * the remaining vertices need at least one backward edge for every cycle among them, so a greedy
+ * packing of edge-disjoint cycles gives the lower bound. The cost of the rest of the order only
+ * depends on the set of placed vertices, so a table of visited sets prunes prefixes that reach
+ * a set at a cost that was already reached before.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "exact.h"
+
+#define STOP_CHECK_INTERVAL 4096
+#define EXACT_BRANCH_VERTICES 2000
+#define MEMO_BYTES (64 << 20)
+#define MEMO_PROBES 4
+
+extern char *prog_name;
+
+/**
+ * @struct branch_t
+ * @brief State of the branch and bound over one component, vertices are numbered from 0 inside it.
+ */
+typedef struct{
+	const graph_t *graph;
+	int base;		///< Dense id of the first vertex of the component.
+	int k;			///< Number of vertices of the component.
+	int first_edge;		///< Index of the first out-edge of the component in out_adjacency.
+	const stop_t *stop;
+	bool stopped;
+	uint64_t nodes;		///< Number of visited nodes of the search tree.
+	bool *placed;		///< Whether a vertex is in the prefix.
+	int *pending;		///< Number of edges into a vertex from vertices that are not placed.
+	int *guide;		///< Vertices in the known order, branches are tried in this order.
+	int *path;		///< The current prefix.
+	int *best_path;		///< The best complete order found.
+	int best;		///< Number of backward edges of best_path.
+	bool *used;		///< Out-edges that belong to a packed cycle.
+	int *visited;		///< Generation in which the breadth-first search reached a vertex.
+	int generation;
+	int *queue;
+	int *parent_vertex;	///< Vertex the breadth-first search reached a vertex from.
+	int *parent_edge;	///< Out-edge the breadth-first search reached a vertex over.
+	int words;		///< Number of 64 bit words of a vertex set.
+	uint64_t *set;		///< Placed vertices as a bit set.
+	uint64_t *keys;		///< Random key of every vertex, the hash of a set is the xor of its keys.
+	uint64_t hash;		///< Hash of set.
+	size_t memo_mask;	///< Number of entries of the table of visited sets minus one.
+	uint64_t *memo_hash;
+	int *memo_cost;		///< Lowest cost a set was reached at, INT_MAX for an empty entry.
+	uint64_t *memo_sets;
+} branch_t;
+
+/**
+ * @brief Mixes a 64 bit value into a well distributed hash key (splitmix64).
+ */
+static uint64_t mixKey(uint64_t x){
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/**
+ * @brief Returns the number of edges into v from vertices outside placed.
+ *
+ * @details masks holds one bit mask of in-neighbors per vertex and layer, layer l has the
+ * in-neighbors that are connected to v by more than l parallel edges.
+ */
+static int subsetCost(const uint32_t *masks, int layers, int k, int v, uint32_t placed){
+	int cost = 0;
+	for(int l = 0; l < layers; l++)
+		cost += __builtin_popcount(masks[(size_t) l * k + v] & ~placed);
+	return cost;
+}
+
+/**
+ * @brief Solves a component with at most EXACT_SUBSET_VERTICES vertices by dynamic programming.
+ *
+ * @details cost[S] is the fewest backward edges of an order that starts with the vertices of S.
+ * The vertex placed last among S pays for its edges from outside S. The optimal order is found
+ * backwards from the full set by looking for a last vertex that attains the minimum.
+ *
+ * @return The minimal number of backward edges, or -1 if the search was stopped.
+ */
+static int solveSubsets(const graph_t *graph, int component, int *position, const stop_t *stop){
+	int base = graph->component_vertices[component];
+	int k = graph->component_vertices[component + 1] - base;
+	int *counts = calloc((size_t) k * k, sizeof(int));
+	if(counts == NULL)
+		printErrorAndExit(prog_name, "malloc of exact search is failed");
+	int layers = 0;
+	for(int v = 0; v < k; v++){
+		for(int i = graph->in_offsets[base + v]; i < graph->in_offsets[base + v + 1]; i++){
+			int count = ++counts[v * k + graph->in_adjacency[i] - base];
+			if(count > layers)
+				layers = count;
+		}
+	}
+	uint32_t *masks = calloc((size_t) layers * k + 1, sizeof(uint32_t));
+	size_t subsets = (size_t) 1 << k;
+	uint16_t *cost = malloc(subsets * sizeof(uint16_t));
+	if(masks == NULL || cost == NULL)
+		printErrorAndExit(prog_name, "malloc of exact search is failed");
+	for(int v = 0; v < k; v++)
+		for(int u = 0; u < k; u++)
+			for(int l = 0; l < counts[v * k + u]; l++)
+				masks[(size_t) l * k + v] |= 1u << u;
+	free(counts);
+
+	cost[0] = 0;
+	for(size_t s = 1; s < subsets; s++){
+		if(s % STOP_CHECK_INTERVAL == 0 && stopRequested(stop)){
+			free(masks);
+			free(cost);
+			return -1;
+		}
+		uint32_t placed = (uint32_t) s;
+		int best = INT_MAX;
+		for(uint32_t rest = placed; rest != 0; rest &= rest - 1){
+			int v = __builtin_ctz(rest);
+			int c = cost[placed & ~(1u << v)] + subsetCost(masks, layers, k, v, placed);
+			if(c < best)
+				best = c;
+		}
+		cost[s] = (uint16_t) best;
+	}
+
+	uint32_t placed = (uint32_t)(subsets - 1);
+	int result = cost[placed];
+	for(int p = k - 1; p >= 0; p--){
+		for(uint32_t rest = placed; rest != 0; rest &= rest - 1){
+			int v = __builtin_ctz(rest);
+			uint32_t prefix = placed & ~(1u << v);
+			if(cost[prefix] + subsetCost(masks, layers, k, v, placed) == cost[placed]){
+				position[base + v] = base + p;
+				placed = prefix;
+				break;
+			}
+		}
+	}
+	free(masks);
+	free(cost);
+	return result;
+}
+
+/**
+ * @brief Looks for a shortest cycle through s over unplaced vertices and unused edges.
+ *
+ * @details If a cycle is found, its edges are marked as used, so the packed cycles stay edge-disjoint.
+ *
+ * @return true if a cycle was found.
+ */
+static bool packCycle(branch_t *b, int s){
+	const graph_t *graph = b->graph;
+	int head = 0;
+	int tail = 0;
+	b->generation++;
+	b->visited[s] = b->generation;
+	b->queue[tail++] = s;
+	while(head < tail){
+		int x = b->queue[head++];
+		for(int i = graph->out_offsets[b->base + x]; i < graph->out_offsets[b->base + x + 1]; i++){
+			int y = graph->out_adjacency[i] - b->base;
+			if(b->used[i - b->first_edge] || b->placed[y])
+				continue;
+			if(y == s){
+				b->used[i - b->first_edge] = true;
+				for(int z = x; z != s; z = b->parent_vertex[z])
+					b->used[b->parent_edge[z]] = true;
+				return true;
+			}
+			if(b->visited[y] != b->generation){
+				b->visited[y] = b->generation;
+				b->parent_vertex[y] = x;
+				b->parent_edge[y] = i - b->first_edge;
+				b->queue[tail++] = y;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Returns a lower bound of the backward edges among the unplaced vertices.
+ *
+ * @details Every cycle among them needs its own backward edge, so the number of greedily
+ * packed edge-disjoint cycles is a lower bound.
+ */
+static int cycleBound(branch_t *b){
+	int edges = b->graph->out_offsets[b->base + b->k] - b->first_edge;
+	memset(b->used, 0, (size_t) edges * sizeof(bool));
+	int bound = 0;
+	for(int s = 0; s < b->k; s++){
+		if(b->placed[s] || b->pending[s] == 0)
+			continue;
+		while(packCycle(b, s))
+			bound++;
+	}
+	return bound;
+}
+
+/**
+ * @brief Appends v to the prefix, its out-neighbors lose a pending in-edge.
+ */
+static void placeVertex(branch_t *b, int v, int depth){
+	const graph_t *graph = b->graph;
+	b->placed[v] = true;
+	b->path[depth] = v;
+	b->set[v / 64] |= (uint64_t) 1 << (v % 64);
+	b->hash ^= b->keys[v];
+	for(int i = graph->out_offsets[b->base + v]; i < graph->out_offsets[b->base + v + 1]; i++)
+		b->pending[graph->out_adjacency[i] - b->base]--;
+}
+
+/**
+ * @brief Removes v from the end of the prefix again.
+ */
+static void unplaceVertex(branch_t *b, int v){
+	const graph_t *graph = b->graph;
+	b->placed[v] = false;
+	b->set[v / 64] &= ~((uint64_t) 1 << (v % 64));
+	b->hash ^= b->keys[v];
+	for(int i = graph->out_offsets[b->base + v]; i < graph->out_offsets[b->base + v + 1]; i++)
+		b->pending[graph->out_adjacency[i] - b->base]++;
+}
+
+/**
+ * @brief Looks up the set of placed vertices in the table of visited sets.
+ *
+ * @details If the set was reached before at a cost that is not higher, every order that continues
+ * the prefix was already considered. Otherwise the set is recorded with the current cost, replacing
+ * one of the probed entries if all of them are taken.
+ *
+ * @return true if the prefix can be pruned.
+ */
+static bool memoVisited(branch_t *b, int cost){
+	size_t words = (size_t) b->words;
+	size_t victim = (b->hash + (b->hash >> 32) % MEMO_PROBES) & b->memo_mask;
+	for(size_t p = 0; p < MEMO_PROBES; p++){
+		size_t i = (b->hash + p) & b->memo_mask;
+		if(b->memo_cost[i] == INT_MAX){
+			victim = i;
+			break;
+		}
+		if(b->memo_hash[i] == b->hash && memcmp(b->memo_sets + i * words, b->set, words * sizeof(uint64_t)) == 0){
+			if(b->memo_cost[i] <= cost)
+				return true;
+			b->memo_cost[i] = cost;
+			return false;
+		}
+	}
+	b->memo_hash[victim] = b->hash;
+	b->memo_cost[victim] = cost;
+	memcpy(b->memo_sets + victim * words, b->set, words * sizeof(uint64_t));
+	return false;
+}
+
+/**
+ * @brief Extends the prefix of length depth with every unplaced vertex that can still beat the best order.
+ *
+ * @details A vertex without edges from unplaced vertices is appended without branching, because moving
+ * it to the front of the rest of any order never adds a backward edge.
+ */
+static void branch(branch_t *b, int depth, int cost){
+	if(++b->nodes % STOP_CHECK_INTERVAL == 0 && stopRequested(b->stop))
+		b->stopped = true;
+	if(b->stopped)
+		return;
+	if(depth == b->k){
+		if(cost < b->best){
+			b->best = cost;
+			memcpy(b->best_path, b->path, (size_t) b->k * sizeof(int));
+		}
+		return;
+	}
+	if(memoVisited(b, cost))
+		return;
+	for(int i = 0; i < b->k; i++){
+		int v = b->guide[i];
+		if(!b->placed[v] && b->pending[v] == 0){
+			placeVertex(b, v, depth);
+			branch(b, depth + 1, cost);
+			unplaceVertex(b, v);
+			return;
+		}
+	}
+	if(cost + cycleBound(b) >= b->best)
+		return;
+	for(int i = 0; i < b->k && !b->stopped; i++){
+		int v = b->guide[i];
+		int added = b->pending[v];
+		if(b->placed[v] || cost + added >= b->best)
+			continue;
+		placeVertex(b, v, depth);
+		branch(b, depth + 1, cost + added);
+		unplaceVertex(b, v);
+	}
+}
+
+/**
+ * @brief Compares two 64 bit sort keys for qsort.
+ */
+static int compareKeys(const void *a, const void *b){
+	int64_t x = *(const int64_t *) a;
+	int64_t y = *(const int64_t *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Solves a component by branch and bound, starting from the known order.
+ *
+ * @return The minimal number of backward edges, or -1 if the search was stopped.
+ */
+static int solveBranch(const graph_t *graph, int component, int *position, int upper, const stop_t *stop){
+	branch_t b;
+	b.graph = graph;
+	b.base = graph->component_vertices[component];
+	b.k = graph->component_vertices[component + 1] - b.base;
+	b.first_edge = graph->out_offsets[b.base];
+	b.stop = stop;
+	b.stopped = false;
+	b.nodes = 0;
+	b.best = upper;
+	b.generation = 0;
+	size_t k = (size_t) b.k;
+	size_t edges = (size_t)(graph->out_offsets[b.base + b.k] - b.first_edge);
+	int64_t *keys = malloc(k * sizeof(int64_t));
+	b.placed = calloc(k, sizeof(bool));
+	b.pending = malloc(k * sizeof(int));
+	b.guide = malloc(k * sizeof(int));
+	b.path = malloc(k * sizeof(int));
+	b.best_path = malloc(k * sizeof(int));
+	b.used = malloc((edges + 1) * sizeof(bool));
+	b.visited = calloc(k, sizeof(int));
+	b.queue = malloc(k * sizeof(int));
+	b.parent_vertex = malloc(k * sizeof(int));
+	b.parent_edge = malloc(k * sizeof(int));
+	b.words = (b.k + 63) / 64;
+	b.set = calloc((size_t) b.words, sizeof(uint64_t));
+	b.keys = malloc(k * sizeof(uint64_t));
+	b.hash = 0;
+	size_t entry = (size_t) b.words * sizeof(uint64_t) + sizeof(uint64_t) + sizeof(int);
+	size_t entries = 1;
+	while(entries * 2 * entry <= MEMO_BYTES)
+		entries *= 2;
+	b.memo_mask = entries - 1;
+	b.memo_hash = malloc(entries * sizeof(uint64_t));
+	b.memo_cost = malloc(entries * sizeof(int));
+	b.memo_sets = malloc(entries * (size_t) b.words * sizeof(uint64_t));
+	if(keys == NULL || b.placed == NULL || b.pending == NULL || b.guide == NULL || b.path == NULL
+			|| b.best_path == NULL || b.used == NULL || b.visited == NULL || b.queue == NULL
+			|| b.parent_vertex == NULL || b.parent_edge == NULL || b.set == NULL || b.keys == NULL
+			|| b.memo_hash == NULL || b.memo_cost == NULL || b.memo_sets == NULL)
+		printErrorAndExit(prog_name, "malloc of exact search is failed");
+
+	for(int v = 0; v < b.k; v++){
+		keys[v] = (int64_t) position[b.base + v] << 32 | v;
+		b.pending[v] = graph->in_offsets[b.base + v + 1] - graph->in_offsets[b.base + v];
+		b.keys[v] = mixKey((uint64_t) v);
+	}
+	for(size_t i = 0; i < entries; i++)
+		b.memo_cost[i] = INT_MAX;
+	qsort(keys, k, sizeof(int64_t), compareKeys);
+	for(int i = 0; i < b.k; i++)
+		b.guide[i] = b.best_path[i] = (int)(keys[i] & 0xffffffff);
+	free(keys);
+
+	branch(&b, 0, 0);
+
+	int result = b.stopped ? -1 : b.best;
+	if(!b.stopped)
+		for(int i = 0; i < b.k; i++)
+			position[b.base + b.best_path[i]] = b.base + i;
+	free(b.placed);
+	free(b.pending);
+	free(b.guide);
+	free(b.path);
+	free(b.best_path);
+	free(b.used);
+	free(b.visited);
+	free(b.queue);
+	free(b.parent_vertex);
+	free(b.parent_edge);
+	free(b.set);
+	free(b.keys);
+	free(b.memo_hash);
+	free(b.memo_cost);
+	free(b.memo_sets);
+	return result;
+}
+
+/**
+ * @brief Finds a vertex order of a component with the fewest backward edges.
+ *
+ * @details Components with at most EXACT_SUBSET_VERTICES vertices are solved by dynamic programming,
+ * larger ones by branch and bound. Components with more than EXACT_BRANCH_VERTICES vertices are
+ * not searched, because the recursion of the branch and bound is as deep as the component.
+ *
+ * @param graph The reduced graph.
+ * @param component The component to solve.
+ * @param position Position of every vertex. On entry the positions of the component's vertices
+ * are a known order with upper backward edges, on return they are an optimal order.
+ * @param upper The number of backward edges of the component in the known order.
+ * @param stop The search returns early once one of these flags is set.
+ * @return The minimal number of backward edges, or -1 if the search was stopped or the component is too large.
+ */
+int exactSolve(const graph_t *graph, int component, int *position, int upper, const stop_t *stop){
+	int k = graph->component_vertices[component + 1] - graph->component_vertices[component];
+	int edges = graph->component_edges[component + 1] - graph->component_edges[component];
+	if(k <= EXACT_SUBSET_VERTICES && edges < UINT16_MAX)
+		return solveSubsets(graph, component, position, stop);
+	if(k > EXACT_BRANCH_VERTICES)
+		return -1;
+	return solveBranch(graph, component, position, upper, stop);
+}
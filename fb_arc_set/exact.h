@@ -0,0 +1,30 @@
+/*
+ * @file exact.h
+ * @brief exact minimal feedback arc set of a strongly connected component
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef EXACT
+#define EXACT
+
+#include "graph.h"
+
+/**
+ * @brief Components with at most this many vertices are solved by dynamic programming over subsets.
+ */
+#define EXACT_SUBSET_VERTICES 25
+
+/**
+ * @brief Finds a vertex order of a component with the fewest backward edges.
+ *
+ * @param graph The reduced graph.
+ * @param component The component to solve.
+ * @param position Position of every vertex. On entry the positions of the component's vertices
+ * are a known order with upper backward edges, on return they are an optimal order.
+ * @param upper The number of backward edges of the component in the known order.
+ * @param stop The search returns early once one of these flags is set.
+ * @return The minimal number of backward edges, or -1 if the search was stopped or the component is too large.
+ */
+int exactSolve(const graph_t *graph, int component, int *position, int upper, const stop_t *stop);
+
+#endif
@@ -7,185 +7,315 @@
  * @date 11.12.2023
  */
 #include "common.h"
+#include "graph.h"
+#include "rng.h"
+#include "ring.h"
+#include "search.h"
+#include "exact.h"
+#include "score.h"
+#include "checkpoint.h"
+#include "instance.h"
 #include <time.h>
+#include <signal.h>
+
+#define DEFAULT_TEMPERATURE 2.0
+#define DEFAULT_COOLING 0.95
+#define DEFAULT_ROUNDS 1
+#define FINAL_TEMPERATURE 0.05
+
+/**
+ * @brief How a candidate order is produced.
+ */
+typedef enum{
+	MODE_RANDOM,	///< Random order, evaluated as it is.
+	MODE_LOCAL,	///< Random order improved by local search.
+	MODE_GREEDY,	///< Eades-Lin-Smyth greedy order improved by local search.
+	MODE_ANNEAL,	///< Random order improved by simulated annealing.
+	MODE_EXACT	///< Greedy order as upper bound, then every component is solved exactly.
+} search_mode_t;
 
 /**
- * @struct list_of_vertices_t
- * @brief Represents a list of vertices.
- * @details This structure includes an array of integers representing vertices and the size of the list.
+ * @struct generator_t
+ * @brief Structure to represent generator configuration parameters.
+ * @details The structure includes the search mode, the pass limit of the local search, the
+ * cooling schedule of the simulated annealing, the checkpoint the search starts from, NULL for none,
+ * and the id of the supervisor's instance.
  */
 typedef struct{
-	int list[DEFAULT_EDGES_AMOUNT];
-	int size;
-} list_of_vertices_t;
+	search_mode_t mode;
+	int passes;
+	anneal_t schedule;
+	const char *checkpoint;
+	const char *instance;
+} generator_t;
 
 char *prog_name;
-list_of_edges_t list_of_edges;
-list_of_vertices_t list_of_vertices;
-list_of_edges_t solution;
+volatile sig_atomic_t quit = 0;
+generator_t generator;
+rng_t rng;
+graph_t graph;
+int *order;
+int *position;
+int *component_best;
+int *best_position;
+int *positions[SCORE_ORDERS];
+int *backward;
+int local_best = INT_MAX;
+bool warm_start = false;
+search_t search;
+batch_t *batch;
+producer_stats_t *stats;
+int last_record;
+struct timespec batch_time;
+struct timespec count_time;
 
 /**
- * @brief Parses a string into an integer.
+ * @brief Signal handler function to handle termination signals.
  *
- * @details This function converts the input string to an integer using the strtol function.
- * It also performs error checking to ensure that the conversion is successful and the integer
- * value is within the valid range.
+ * @details This function sets the quit flag to 1 upon receiving a termination signal, so the generator
+ * leaves its loop after the current candidate and never dies while it holds a slot of the ring. The
+ * search polls the flag as well, so a long annealing or exact search returns early.
  *
- * @param str The input string to be converted.
- * @return The integer value parsed from the string.
- * @throws Exits the program with an error message if the string cannot be represented as an integer
- * or if the parsed value exceeds the maximum allowed integer value.
+ * @param signal The signal number received.
  */
+void handle_sign(int signal){
+	quit = 1;
+}
 
-int parseStringToInteger(char *str){
-	char *ptr;
-	long int ret = strtol(str, &ptr, 10);
-	if(*ptr != '\0' || ret > INT_MAX){
-		printErrorAndExit(prog_name, "string cannot represented as integer");
-	}
-	return (int) ret;
+/**
+ * @brief Sets up signal actions for handling termination signals (SIGINT and SIGTERM).
+ */
+void setUpSignalAction(void){
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_sign;
+	if (sigaction(SIGINT, &sa, NULL) == -1)
+		printErrorAndExit(prog_name, "sigaction with SIGINT is failed");
+	if (sigaction(SIGTERM, &sa, NULL) == -1)
+		printErrorAndExit(prog_name, "sigaction with SIGTERM is failed");
 }
 
 /**
- * @brief Validates and parses an edge represented by a string.
- *
- * @details This function takes an input string representing an edge in the format "start-end".
- * It validates the format, extracts the start and end vertices, and adds the edge to the global
- * list_of_edges.
- *
- * @param input The input string representing the edge.
+ * @brief Parses a string into a positive double.
  *
+ * @param str The input string to be converted.
+ * @return The value parsed from the string.
+ * @throws Exits the program with an error message if the string is not a positive number.
  */
-void validateEdge(char *input){
-	char *separator = strchr(input, '-');
-	if(separator == NULL)
-		printErrorAndExit(prog_name, "edge is invalid");
-	char *part1;
-	part1 = (char *)malloc(separator - input + 1);
-	if(part1 == NULL)
-		printErrorAndExit(prog_name, "split edge string is failed (part1)");
-	strncpy(part1, input, separator - input);
-	part1[separator - input] = '\0';
-	
-	char* part2 = strdup(separator + 1);
-	if(part2 == NULL){
-		free(part1);
-		printErrorAndExit(prog_name, "split edge string is failed (part2)");
-	}
-	
-	edge_t edge;
-	edge.start = parseStringToInteger(part1);
-	edge.end = parseStringToInteger(part2);
-	list_of_edges.list[list_of_edges.size] = edge;
-	list_of_edges.size++;
-	free(part1);
-	free(part2);
+double parseStringToDouble(char *str){
+	char *ptr;
+	double ret = strtod(str, &ptr);
+	if(*ptr != '\0' || !(ret > 0))
+		printErrorAndExit(prog_name, "string cannot represented as positive number");
+	return ret;
 }
 
 /**
- * @brief Validates and sets the list of edges based on command-line arguments.
+ * @brief Parses command-line options to set the generator configuration.
  *
- * @details This function takes the command-line arguments and validates the number of edges and
- * their format. It then calls the validateEdge function for each edge to build the list_of_edges.
+ * @details Supports '-m mode' to choose how candidates are produced (random, local, greedy, anneal or exact) and
+ * '-k passes' to limit the passes of the local search (0, the default, runs until no move improves).
+ * More local search means fewer but better candidates per second. The annealing is configured with
+ * '-T temperature' (start temperature), '-c cooling' (factor per round, below 1) and '-s rounds'
+ * (moves per temperature in multiples of the number of vertices). '-w file' seeds the search with
+ * the order of a checkpoint the supervisor saved. '-i id' is required and selects the supervisor, it
+ * is the id the supervisor printed or was given with its own -i. If an option is specified more
+ * than once, an error is reported and the program exits.
  *
  * @param argc The number of command-line arguments.
  * @param argv An array of command-line argument strings.
+ * @param generator A pointer to the generator_t structure to store the parsed configuration.
  */
-void validateAndSetListOfEdges(int argc, char *argv[]){
-	if(argc == 1)
-		printErrorAndExit(prog_name, "requires list of edges");
-	if((argc - 1) > DEFAULT_EDGES_AMOUNT)
-		printErrorAndExit(prog_name, "the programm cannot process so many edges of the graph");
-	list_of_edges.size = 0;
-	for(int i = 1; i < argc; i++){
-		validateEdge(argv[i]);
+void getArgumentsSetGenerator(int argc, char *argv[], generator_t *generator){
+	int opt;
+	int count_m = 0;
+	int count_k = 0;
+	int count_T = 0;
+	int count_c = 0;
+	int count_s = 0;
+	int count_w = 0;
+	int count_i = 0;
+	generator->mode = MODE_RANDOM;
+	generator->passes = 0;
+	generator->schedule.temperature = DEFAULT_TEMPERATURE;
+	generator->schedule.cooling = DEFAULT_COOLING;
+	generator->schedule.final = FINAL_TEMPERATURE;
+	generator->schedule.rounds = DEFAULT_ROUNDS;
+	generator->checkpoint = NULL;
+	generator->instance = NULL;
+	while((opt = getopt(argc, argv, "m:k:T:c:s:w:i:")) != -1){
+		switch(opt){
+			case 'm':{
+				if(count_m++ != 0)
+					printErrorAndExit(prog_name, "more than one m");
+				if(strcmp(optarg, "random") == 0)
+					generator->mode = MODE_RANDOM;
+				else if(strcmp(optarg, "local") == 0)
+					generator->mode = MODE_LOCAL;
+				else if(strcmp(optarg, "greedy") == 0)
+					generator->mode = MODE_GREEDY;
+				else if(strcmp(optarg, "anneal") == 0)
+					generator->mode = MODE_ANNEAL;
+				else if(strcmp(optarg, "exact") == 0)
+					generator->mode = MODE_EXACT;
+				else
+					printErrorAndExit(prog_name, "mode is invalid (random, local, greedy, anneal, exact)");
+				break;
+			}
+			case 'T':{
+				if(count_T++ != 0)
+					printErrorAndExit(prog_name, "more than one T");
+				generator->schedule.temperature = parseStringToDouble(optarg);
+				break;
+			}
+			case 'c':{
+				if(count_c++ != 0)
+					printErrorAndExit(prog_name, "more than one c");
+				generator->schedule.cooling = parseStringToDouble(optarg);
+				if(generator->schedule.cooling >= 1)
+					printErrorAndExit(prog_name, "cooling must be below 1");
+				break;
+			}
+			case 's':{
+				if(count_s++ != 0)
+					printErrorAndExit(prog_name, "more than one s");
+				generator->schedule.rounds = parseStringToInteger(optarg);
+				if(generator->schedule.rounds <= 0)
+					printErrorAndExit(prog_name, "rounds must be positive");
+				break;
+			}
+			case 'k':{
+				if(count_k++ != 0)
+					printErrorAndExit(prog_name, "more than one k");
+				generator->passes = parseStringToInteger(optarg);
+				if(generator->passes < 0)
+					printErrorAndExit(prog_name, "passes must not be negative");
+				break;
+			}
+			case 'w':{
+				if(count_w++ != 0)
+					printErrorAndExit(prog_name, "more than one w");
+				generator->checkpoint = optarg;
+				break;
+			}
+			case 'i':{
+				if(count_i++ != 0)
+					printErrorAndExit(prog_name, "more than one i");
+				generator->instance = optarg;
+				break;
+			}
+			case '?':{
+				printErrorAndExit(prog_name, "option is invalid");
+				break;
+			}
+			default:
+				printErrorAndExit(prog_name, "unknown error");
+		}
 	}
+	if(generator->instance == NULL)
+		printErrorAndExit(prog_name, "instance of the supervisor is required (-i id)");
 }
 
 /**
- * @brief Finds the index of an element in the list_of_vertices.
- *
- * @details This function searches for the specified element in the list_of_vertices.list.
- * If found, it returns the index of the element; otherwise, it returns -1.
+ * @brief Generates a random integer within a specified range.
  *
- * @param elem The element to search for in the list_of_vertices.
- * @return The index of the element in the list_of_vertices.list, or -1 if not found.
+ * @details This function generates a random integer between the given lower and upper bounds (inclusive)
+ * with the generator's own unbiased rng instead of rand() % n.
  *
+ * @param lower The lower bound of the random number range.
+ * @param upper The upper bound of the random number range.
+ * @return A random integer within the specified range.
  */
-int indexOfElementInVertices(int elem){
-	int size = list_of_vertices.size;
-	for(int i = 0; i < size; i++){
-		if(elem == list_of_vertices.list[i])
-			return i;
-	}
-	return -1;
+int generateRandomNumber(int lower, int upper){
+	return (int) rngBounded(&rng, (uint32_t)(upper - lower + 1)) + lower;
 }
 
 /**
- * @brief Adds an element to the list_of_vertices if it does not already exist.
- *
- * @details This function checks if the specified element already exists in the list_of_vertices.
- * If not, it adds the element to the list.
+ * @brief Allocates the vertex order and its inverse permutation.
  *
- * @param elem The element to add to the list_of_vertices.
- *
- *  
+ * @details order starts as the identity, so every dense vertex id appears exactly once. Also allocates
+ * the best result of every component, the positions of the further random orders that are scored
+ * together with position, and room for the indices of the backward edges.
  */
-void addElemToListOfVertices(int elem){
-	if(indexOfElementInVertices(elem) == -1){
-		list_of_vertices.list[list_of_vertices.size] = elem;
-		list_of_vertices.size++;
+void createOrder(void){
+	size_t n = (size_t) graph.vertices_amount + 1;
+	order = malloc(n * sizeof(int));
+	position = malloc(n * sizeof(int));
+	best_position = malloc(n * sizeof(int));
+	component_best = malloc(((size_t) graph.components_amount + 1) * sizeof(int));
+	backward = malloc(((size_t) graph.edges_amount + SCORE_PADDING) * sizeof(int));
+	if(order == NULL || position == NULL || best_position == NULL || component_best == NULL || backward == NULL)
+		printErrorAndExit(prog_name, "malloc of vertex order is failed");
+	positions[0] = position;
+	for(int k = 1; k < SCORE_ORDERS; k++){
+		positions[k] = malloc(n * sizeof(int));
+		if(positions[k] == NULL)
+			printErrorAndExit(prog_name, "malloc of vertex order is failed");
 	}
+	for(int i = 0; i < graph.vertices_amount; i++)
+		order[i] = i;
+	for(int c = 0; c < graph.components_amount; c++)
+		component_best[c] = INT_MAX;
 }
 
 /**
- * @brief Creates a list of vertices from the list_of_edges.
+ * @brief Generates a random order of the vertices by shuffling order.
  *
- * @details This function initializes the list_of_vertices and populates it with unique vertices
- * from the list_of_edges. It calls addElemToListOfVertices for each start and end vertex in the edges.
+ * @details Shuffles order in place (Fisher-Yates) and then fills the inverse permutation,
+ * so the position of a vertex in the order is one array access.
  *
+ * @param inverse Receives the position of every vertex, position or one of positions.
  */
-void createListOfVertices(void){
-	list_of_vertices.size = 0;
-	int size = list_of_edges.size;
-	for(int i = 0; i < size; i++){
-		addElemToListOfVertices(list_of_edges.list[i].start);
-		addElemToListOfVertices(list_of_edges.list[i].end);
+void generateRandomListOfVertices(int *inverse){
+	for(int i = graph.vertices_amount - 1; i > 0; i--){
+		int randomNumber = generateRandomNumber(0, i);
+		int tmp = order[i];
+		order[i] = order[randomNumber];
+		order[randomNumber] = tmp;
 	}
+	for(int i = 0; i < graph.vertices_amount; i++)
+		inverse[order[i]] = i;
 }
 
 /**
- * @brief Generates a random integer within a specified range.
+ * @brief Produces the next candidate order according to the generator mode.
  *
- * @details This function generates a random integer between the given lower and upper bounds (inclusive).
- *
- * @param lower The lower bound of the random number range.
- * @param upper The upper bound of the random number range.
- * @return A random integer within the specified range.
- */
-int generateRandomNumber(int lower, int upper){
-	return rand() % (upper - lower + 1) + lower;
-}
-
-/**
- * @brief Generates a random list of vertices by shuffling the existing list_of_vertices.
+ * @details In the local and greedy modes the start order is improved with vertex sifting until
+ * it is a local optimum, in the anneal mode a random order is annealed. The exact mode starts
+ * like the greedy mode, its candidates are the upper bounds of the exact search. The result is
+ * then evaluated like a random order. The random mode produces SCORE_ORDERS orders, which are
+ * scored in one pass over the edges. The first candidate of a generator started from a checkpoint
+ * is the order of the checkpoint, improved with vertex sifting in every mode, so that vertices the
+ * checkpoint did not know move to a good position.
  *
- * @details This function initializes a new list_of_vertices, shuffles the existing list_of_vertices,
- * and then copies the shuffled elements to the new list.
- *.
+ * @return The number of orders in positions.
  */
-void generateRandomListOfVertices(void){
-	list_of_vertices_t list_of_vertices2;
-	list_of_vertices2.size = 0;
-	
-	while(list_of_vertices.size != 0){
-		int randomNumber = generateRandomNumber(0, list_of_vertices.size - 1);
-		list_of_vertices2.list[list_of_vertices2.size] = list_of_vertices.list[randomNumber];
-		list_of_vertices.list[randomNumber] = list_of_vertices.list[list_of_vertices.size - 1];
-		list_of_vertices2.size++;
-		list_of_vertices.size--;
-	}	
-	list_of_vertices = list_of_vertices2;
+int generateCandidate(void){
+	if(warm_start){
+		warm_start = false;
+		searchSifting(&search, generator.passes);
+		return 1;
+	}
+	switch(generator.mode){
+		case MODE_RANDOM:
+			for(int k = 0; k < SCORE_ORDERS; k++)
+				generateRandomListOfVertices(positions[k]);
+			return SCORE_ORDERS;
+		case MODE_LOCAL:
+			generateRandomListOfVertices(position);
+			searchSifting(&search, generator.passes);
+			break;
+		case MODE_GREEDY:
+		case MODE_EXACT:
+			searchGreedyOrder(&search);
+			searchSifting(&search, generator.passes);
+			break;
+		case MODE_ANNEAL:
+			generateRandomListOfVertices(position);
+			searchAnneal(&search, &generator.schedule);
+			break;
+	}
+	return 1;
 }
 
 /**
@@ -195,81 +325,241 @@ void generateRandomListOfVertices(void){
  *
  * @param edges The list_of_edges to be printed.
  */
-void printListOfEdges(list_of_edges_t edges){
-	int size = edges.size;
+void printListOfEdges(const list_of_edges_t *edges){
+	int size = edges->size;
 	for(int i = 0; i < size; i++){
-		printf("%d-%d ", edges.list[i].start, edges.list[i].end);
+		printf("%d-%d ", edges->list[i].start, edges->list[i].end);
 	}
 	printf("\n");
 }
 
 
 /**
- * @brief Prints the list of vertices to the standard output.
+ * @brief Prints the current vertex order to the standard output.
  *
- * @details This function prints each vertex in the global list_of_vertices to the standard output.
+ * @details This function prints the original id of each vertex in the order to the standard output.
  */
 void printVertices(void){
-	int size = list_of_vertices.size;
+	int size = graph.vertices_amount;
 	for(int i = 0; i < size; i++)
-		printf("%d ", list_of_vertices.list[i]);
+		printf("%d ", graph.vertex_ids[order[i]]);
 	printf("\n");
 }
 
+/**
+ * @brief Writes the indices of the backward edges of the best positions of every component.
+ *
+ * @details The indices refer to the list of edges the graph was read from, which is the same list
+ * the supervisor holds, so a removed edge takes one integer instead of two vertices.
+ *
+ * @param indices Room for local_best indices.
+ */
+void fillSolution(int *indices){
+	int amount = scoreCollect(graph.edge_starts, graph.edge_ends, graph.edges_amount, best_position, backward);
+	for(int i = 0; i < amount; i++)
+		indices[i] = graph.edge_ids[backward[i]];
+	//printVertices();
+}
+
 /**
  * @brief Generates a solution by selecting edges where the start vertex has a higher index than the end vertex.
  *
- * @details This function initializes the global solution list_of_edges by iterating through the list_of_edges.
- * For each edge, if the index of the start vertex is greater than the index of the end vertex in the
- *  list_of_vertices, the edge is added to the solution.
- *      
+ * @details The graph only holds the non-trivial strongly connected components, which are independent:
+ * the backward edges of an order are the union of the backward edges inside every component. So every
+ * component keeps the best result it has had in any candidate, in component_best and best_position,
+ * and the solution combines those. Each component is evaluated with one pass over its edges for all
+ * orders of the candidate, which is abandoned as soon as every order reaches the component's best.
+ * The combined size is kept in local_best.
+ *
+ * @param bound The size of the best known solution.
+ * @param orders Receives the number of orders that were evaluated.
+ * @return true if local_best improved and is smaller than bound, false if the candidate brought no improvement.
  */
-list_of_edges_t generateSolution(void){
-	generateRandomListOfVertices();
-	list_of_edges_t solution_new;
-	int size = list_of_edges.size;
-	edge_t edge;
-	solution_new.size = 0;
-	for(int i = 0; i < size; i++){
-		edge = list_of_edges.list[i];
-		if(indexOfElementInVertices(edge.start) > indexOfElementInVertices(edge.end)){
-			solution_new.list[solution_new.size] = edge;
-			solution_new.size++;
+bool generateSolution(int bound, int *orders){
+	*orders = generateCandidate();
+	int costs[SCORE_ORDERS];
+	int total = 0;
+	for(int c = 0; c < graph.components_amount; c++){
+		int limit = component_best[c];
+		int best = 0;
+		if(*orders == 1)
+			costs[0] = scoreEdges(graph.edge_starts, graph.edge_ends, graph.component_edges[c],
+					graph.component_edges[c + 1], position, limit);
+		else
+			scoreOrders(graph.edge_starts, graph.edge_ends, graph.component_edges[c], graph.component_edges[c + 1],
+					(const int *const *) positions, *orders, limit, costs);
+		for(int k = 1; k < *orders; k++)
+			if(costs[k] < costs[best])
+				best = k;
+		if(costs[best] < limit){
+			component_best[c] = costs[best];
+			memcpy(best_position + graph.component_vertices[c], positions[best] + graph.component_vertices[c],
+					(size_t)(graph.component_vertices[c + 1] - graph.component_vertices[c]) * sizeof(int));
 		}
+		total += component_best[c];
 	}
-	//printVertices();
-	//printListOfEdges(solution_new);
-	return solution_new;
-	
+	if(total >= local_best)
+		return false;
+	local_best = total;
+	return total < bound;
+}
+
+/**
+ * @brief Publishes the private batch in a slot of the ring and empties it.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ * @return false if the supervisor stopped the ring, true otherwise.
+ */
+bool flushBatch(myshm_t *myshm){
+	if(batch->records == 0)
+		return true;
+	unsigned ticket;
+	batch_t *slot = ringReserve(myshm, &ticket, stats);
+	if(slot == NULL)
+		return false;
+	memcpy(slot, batch, BATCH_SIZE(batch->used));
+	ringPublish(myshm, ticket);
+	batch->records = 0;
+	batch->used = 0;
+	return true;
 }
 
 /**
- * @brief Writes the generated solution to a shared memory buffer.
+ * @brief Records local_best with its removed edges in the private batch.
  *
- * @details This function generates a solution using the generateSolution function and then writes
- * the solution to the shared memory buffer specified by the provided myshm structure. The write_index
- * is updated accordingly.
+ * @details The batch is published first if the record does not fit. The previous record of the batch
+ * is worse, so its edge indices are dropped and only its size stays: the supervisor only needs the
+ * edges of the best solution.
  *
  * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ * @return false if the supervisor stopped the ring, true otherwise.
+ */
+bool recordSolution(myshm_t *myshm){
+	if(batch->records != 0 && batch->data[last_record] > local_best){
+		batch->data[last_record + 1] = 0;
+		batch->used = last_record + RECORD_INTS(0);
+	}
+	if(batch->used + RECORD_INTS(local_best) > myshm->batch_capacity && !flushBatch(myshm))
+		return false;
+	if(batch->records == 0)
+		clock_gettime(CLOCK_MONOTONIC, &batch_time);
+	last_record = batch->used;
+	batch->data[last_record] = local_best;
+	batch->data[last_record + 1] = local_best;
+	fillSolution(batch->data + last_record + 2);
+	batch->used += RECORD_INTS(local_best);
+	batch->records++;
+	return true;
+}
+
+/**
+ * @brief Returns whether the first record of the private batch waited BATCH_DELAY_MS.
+ */
+bool batchExpired(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	long waited_ms = (now.tv_sec - batch_time.tv_sec) * 1000 + (now.tv_nsec - batch_time.tv_nsec) / 1000000;
+	return waited_ms >= BATCH_DELAY_MS;
+}
+
+/**
+ * @brief Returns whether the candidates were last counted BATCH_DELAY_MS ago.
  *
+ * @details Candidates of large graphs take long, so waiting for CANDIDATE_FLUSH of them would leave the
+ * shared count and the telemetry behind for seconds. The coarse clock is cheap enough to be read for
+ * every candidate.
  */
-void writeSolution(myshm_t *myshm){
-	myshm->buffer[myshm->write_index] = generateSolution();
-	myshm->write_index = (myshm->write_index + 1) % BUFFER_SIZE;
+bool countExpired(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+	long waited_ms = (now.tv_sec - count_time.tv_sec) * 1000 + (now.tv_nsec - count_time.tv_nsec) / 1000000;
+	return waited_ms >= BATCH_DELAY_MS;
+}
+
+/**
+ * @brief Records the generated solution if it improves the best known solution, and publishes the batch.
+ *
+ * @details This function generates a solution using the generateSolution function, no slot is held
+ * while the candidate is evaluated. Candidates that do not beat the shared best_bound are dropped.
+ * Otherwise the bound is lowered, so the other generators prune against it immediately, and the
+ * solution is recorded in the private batch. The batch is published once its first record waited
+ * BATCH_DELAY_MS, and before the candidates are counted, so the supervisor finds every improvement
+ * in the ring once the count reaches its limit. The candidates are counted every CANDIDATE_FLUSH
+ * candidates or BATCH_DELAY_MS, whichever comes first, and then the generator also checks that its
+ * supervisor is still running, which covers generators that were not started by the supervisor.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ * @return false if the supervisor stopped the ring or died, true otherwise.
+ */
+bool writeSolution(myshm_t *myshm){
+	static uint64_t candidates = 0;
+	int orders;
+	bool improved = generateSolution(ringBound(myshm), &orders);
+	candidates += (uint64_t) orders;
+	if(improved && ringLowerBound(myshm, local_best) && !recordSolution(myshm))
+		return false;
+	bool count = candidates >= CANDIDATE_FLUSH || countExpired();
+	if(batch->records != 0 && (count || batchExpired()) && !flushBatch(myshm))
+		return false;
+	if(count){
+		ringAddCandidates(myshm, stats, candidates);
+		candidates = 0;
+		clock_gettime(CLOCK_MONOTONIC_COARSE, &count_time);
+		if(!ringOwnerAlive(myshm))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Exactly solves every component and publishes the minimal solution.
+ *
+ * @details A greedy candidate gives the upper bound and start order of every component, then
+ * every component is solved with exactSolve. The solution is published even if another generator
+ * already published one of the same size, and the optimal flag is only set afterwards, so the
+ * supervisor finds the solution in the ring once it sees the flag.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ * @return true if the minimal solution was published, false if the search was stopped or a
+ * component is too large for the exact search.
+ */
+bool writeExactSolution(myshm_t *myshm){
+	int orders;
+	generateSolution(INT_MAX, &orders);
+	for(int c = 0; c < graph.components_amount; c++){
+		int cost = exactSolve(&graph, c, best_position, component_best[c], &search.stop);
+		if(cost < 0)
+			return false;
+		component_best[c] = cost;
+	}
+	local_best = 0;
+	for(int c = 0; c < graph.components_amount; c++)
+		local_best += component_best[c];
+	ringLowerBound(myshm, local_best);
+	if(!recordSolution(myshm) || !flushBatch(myshm))
+		return false;
+	ringAddCandidates(myshm, stats, 1);
+	ringSetOptimal(myshm);
+	return true;
 }
 
 /**
  *  * @brief The main function of the program.
  *   *
  *    * @details This function serves as the entry point of the program. It performs the following steps:
- * 1. Sets the global variable `prog_name` to the program's name.
- * 2. Validates and sets the list_of_edges based on command-line arguments.
- * 3. Creates a list_of_vertices from the list_of_edges.
- * 4. Generates a random list_of_vertices.
- * 5. Opens a shared memory object and maps it to the process's address space using mmap.
- * 6. Opens semaphores for synchronization.
- * 7. Enters a loop to write solutions to the shared memory until the stop flag is set.
- * 8. Closes and unlinks semaphores, unmaps shared memory, and closes the shared memory descriptor.
+ * 1. Sets the global variable `prog_name` to the program's name and seeds the rng.
+ * 2. Parses the options, the graph is not given to the generator.
+ * 3. Opens the shared memory object of the supervisor's instance and maps it to the process's address space using mmap. The size
+ *    of the mapping is taken from the shared memory object, which the supervisor sized for the graph.
+ * 4. Maps the graph the supervisor stored in its own shared memory object read-only, and creates the
+ *    vertex order and the search on it, seeded from the checkpoint if one is given. Claims an entry for
+ *    its telemetry in the shared memory.
+ * 5. In the exact mode, solves the graph exactly and publishes the minimal solution. Otherwise, or if the
+ *    graph is too large for the exact search, enters a loop to write improving solutions to the ring
+ *    buffer until the stop flag is set, a termination signal is received or the supervisor died. The pool
+ *    has the generator get SIGTERM when the supervisor dies.
+ * 6. Unmaps the shared memory and the graph and closes their descriptors. If the supervisor died, the
+ *    generator unlinks the shared memory objects it left behind with instanceReclaim.
  *             
  * @param argc The number of command-line arguments.
  * @param argv An array of command-line argument strings.
@@ -279,50 +569,84 @@ int main(int argc, char *argv[]){
 	
 	prog_name = argv[0];
 
-	srand(time(NULL));
+	rngSeedUnique(&rng);
+	scoreInit();
 	
-	validateAndSetListOfEdges(argc, argv);
+	getArgumentsSetGenerator(argc, argv, &generator);
 
-	createListOfVertices();
+	setUpSignalAction();
 
-	int fd = shm_open(SHM_NAME, O_RDWR, 0);
+	if(optind < argc)
+		printErrorAndExit(prog_name, "edges are only given to the supervisor");
+
+	instance_t instance;
+	instanceInit(&instance, generator.instance);
+	int fd = shm_open(instance.ring, O_RDWR, 0);
 	if(fd == -1)
 		printErrorAndExit(prog_name, "shm_open is failed");
 
-	myshm_t *myshm = mmap(NULL, sizeof(*myshm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	struct stat shm_stat;
+	if(fstat(fd, &shm_stat) == -1)
+		printErrorAndExit(prog_name, "fstat is failed");
+	size_t shm_size = (size_t) shm_stat.st_size;
+	if(shm_size < sizeof(myshm_t))
+		printErrorAndExit(prog_name, "shared memory is not initialized");
+
+	myshm_t *myshm = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
 	if(myshm == MAP_FAILED)
 		printErrorAndExit(prog_name, "mmap is failed");
-	
 
-	sem_t *free_sem = sem_open("/free_sem", 0);
-	if(free_sem == SEM_FAILED)
-		 printErrorAndExit(prog_name, "sem_open is failed");
-	sem_t *used_sem = sem_open("/used_sem", 0);
-	if(used_sem == SEM_FAILED)
-		printErrorAndExit(prog_name, "sem_open is failed");
-	while(!myshm->stop){
-		if(sem_wait(free_sem) == -1)
-		printErrorAndExit(prog_name, "sem_wait is failed");
-		if(myshm->stop)
-			break;
-		writeSolution(myshm);
+	int graph_fd = shm_open(instance.graph, O_RDONLY, 0);
+	if(graph_fd == -1)
+		printErrorAndExit(prog_name, "shm_open of graph is failed");
+	if(fstat(graph_fd, &shm_stat) == -1)
+		printErrorAndExit(prog_name, "fstat of graph is failed");
+	size_t graph_size = (size_t) shm_stat.st_size;
+	shared_graph_t *shared_graph = mmap(NULL, graph_size, PROT_READ, MAP_SHARED, graph_fd, 0);
+	if(shared_graph == MAP_FAILED)
+		printErrorAndExit(prog_name, "mmap of graph is failed");
+	attachGraph(&graph, shared_graph, graph_size);
+	if(shm_size < SHM_SIZE(myshm->batch_capacity) || RECORD_INTS(shared_graph->input_edges) > myshm->batch_capacity)
+		printErrorAndExit(prog_name, "shared memory is too small for the graph");
 
-		if(sem_post(used_sem) == -1)
-			printErrorAndExit(prog_name, "sem_post failed");
+	createOrder();
+	searchInit(&search, &graph, &rng, order, position);
+	if(generator.checkpoint != NULL){
+		warm_start = checkpointSeed(generator.checkpoint, &graph, order, position);
+		if(!warm_start)
+			fprintf(stderr, "%s: checkpoint %s cannot be read, the search starts without it\n",
+					prog_name, generator.checkpoint);
 	}
+	batch = malloc(BATCH_SIZE(myshm->batch_capacity));
+	if(batch == NULL)
+		printErrorAndExit(prog_name, "malloc of batch is failed");
+	batch->producer = (int) getpid();
+	batch->records = 0;
+	batch->used = 0;
+	stats = ringRegister(myshm);
+	search.stop.ring = &myshm->stop;
+	search.stop.signal = &quit;
+	
 
-	if(sem_close(free_sem) == -1)
-		                printErrorAndExit(prog_name, "sem_close is failed");
-	if(sem_close(used_sem) == -1)
-		printErrorAndExit(prog_name, "sem_close is failed");
+	if(generator.mode != MODE_EXACT || !writeExactSolution(myshm)){
+		while(!quit && !ringStopped(myshm)){
+			if(!writeSolution(myshm))
+				break;
+		}
+	}
 
-	sem_unlink("/free_sem");
-	sem_unlink("/used_sem");
-	
-	if(munmap(myshm, sizeof(*myshm)) == -1)
+	ringUnregister(stats);
+	bool orphaned = !ringOwnerAlive(myshm);
+	if(munmap(myshm, shm_size) == -1)
 		printErrorAndExit(prog_name, "munmap is failed");
 	if(close(fd) == -1)
 		printErrorAndExit(prog_name, "close of fd is failed");	
+	if(munmap(shared_graph, graph_size) == -1)
+		printErrorAndExit(prog_name, "munmap of graph is failed");
+	if(close(graph_fd) == -1)
+		printErrorAndExit(prog_name, "close of graph fd is failed");
+	if(orphaned)
+		instanceReclaim();
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,568 @@
+/*
+ * @file graph.c
+ * @brief parsing of the graph given as a list of edges or a file, and its copy in the shared memory
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "graph.h"
+#include <ctype.h>
+
+extern char *prog_name;
+
+/**
+ * @brief Parses a string into an integer.
+ *
+ * @details This function converts the input string to an integer using the strtol function.
+ * It also performs error checking to ensure that the conversion is successful and the integer
+ * value is within the valid range.
+ *
+ * @param str The input string to be converted.
+ * @return The integer value parsed from the string.
+ * @throws Exits the program with an error message if the string cannot be represented as an integer
+ * or if the parsed value exceeds the maximum allowed integer value.
+ */
+int parseStringToInteger(char *str){
+	char *ptr;
+	long int ret = strtol(str, &ptr, 10);
+	if(*ptr != '\0' || ret > INT_MAX){
+		printErrorAndExit(prog_name, "string cannot represented as integer");
+	}
+	return (int) ret;
+}
+
+/**
+ * @brief Validates and parses an edge represented by a string.
+ *
+ * @details This function takes an input string representing an edge in the format "start-end",
+ * validates the format and extracts the start and end vertices.
+ *
+ * @param input The input string representing the edge.
+ * @return The parsed edge.
+ */
+static edge_t validateEdge(char *input){
+	char *separator = strchr(input, '-');
+	if(separator == NULL)
+		printErrorAndExit(prog_name, "edge is invalid");
+	char *part1;
+	part1 = (char *)malloc(separator - input + 1);
+	if(part1 == NULL)
+		printErrorAndExit(prog_name, "split edge string is failed (part1)");
+	strncpy(part1, input, separator - input);
+	part1[separator - input] = '\0';
+
+	char* part2 = strdup(separator + 1);
+	if(part2 == NULL){
+		free(part1);
+		printErrorAndExit(prog_name, "split edge string is failed (part2)");
+	}
+
+	edge_t edge;
+	edge.start = parseStringToInteger(part1);
+	edge.end = parseStringToInteger(part2);
+	free(part1);
+	free(part2);
+	return edge;
+}
+
+/**
+ * @brief Parses the edges given as "start-end" arguments.
+ *
+ * @details The list is allocated with exactly as many entries as there are edge arguments,
+ * so the size of the graph is only limited by the available memory.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @param first The index of the first edge argument.
+ * @return A newly allocated list_of_edges_t holding all edges.
+ */
+list_of_edges_t *readListOfEdges(int argc, char *argv[], int first){
+	if(argc <= first)
+		printErrorAndExit(prog_name, "requires list of edges");
+	list_of_edges_t *edges = malloc(LIST_OF_EDGES_SIZE(argc - first));
+	if(edges == NULL)
+		printErrorAndExit(prog_name, "malloc of list of edges is failed");
+	edges->size = 0;
+	for(int i = first; i < argc; i++){
+		edges->list[edges->size] = validateEdge(argv[i]);
+		edges->size++;
+	}
+	return edges;
+}
+
+/**
+ * @brief Parses a non-negative decimal vertex of a graph file.
+ *
+ * @param p The first character of the vertex.
+ * @param end The end of the file.
+ * @param vertex Receives the vertex.
+ * @return The first character after the vertex.
+ */
+static const char *parseVertex(const char *p, const char *end, int *vertex){
+	if(p == end || *p < '0' || *p > '9')
+		printErrorAndExit(prog_name, "edge in file is invalid");
+	long value = 0;
+	while(p < end && *p >= '0' && *p <= '9'){
+		value = value * 10 + (*p - '0');
+		if(value > INT_MAX)
+			printErrorAndExit(prog_name, "vertex in file cannot represented as integer");
+		p++;
+	}
+	*vertex = (int) value;
+	return p;
+}
+
+/**
+ * @brief Parses the edges of a graph file, either "start-end" words or the binary format.
+ *
+ * @details The file is mapped instead of read. A file that starts with GRAPH_MAGIC is in the binary
+ * format and its edges are copied as they are. Otherwise the file holds "start-end" words separated
+ * by white space, like the arguments. The edges are counted by their '-' first, so the list is
+ * allocated once, and the vertices are parsed by hand without copying the words.
+ *
+ * @param path The path of the file.
+ * @return A newly allocated list_of_edges_t holding all edges.
+ */
+list_of_edges_t *readListOfEdgesFile(const char *path){
+	int fd = open(path, O_RDONLY);
+	if(fd == -1)
+		printErrorAndExit(prog_name, "open of graph file is failed");
+	struct stat file_stat;
+	if(fstat(fd, &file_stat) == -1)
+		printErrorAndExit(prog_name, "fstat of graph file is failed");
+	size_t size = (size_t) file_stat.st_size;
+	if(size == 0)
+		printErrorAndExit(prog_name, "requires list of edges");
+	const char *file = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(file == MAP_FAILED)
+		printErrorAndExit(prog_name, "mmap of graph file is failed");
+	close(fd);
+
+	list_of_edges_t *edges;
+	if(size >= GRAPH_MAGIC_SIZE + sizeof(int32_t) && memcmp(file, GRAPH_MAGIC, GRAPH_MAGIC_SIZE) == 0){
+		int32_t amount;
+		memcpy(&amount, file + GRAPH_MAGIC_SIZE, sizeof(int32_t));
+		if(amount < 0 || size != GRAPH_MAGIC_SIZE + sizeof(int32_t) + (size_t) amount * 2 * sizeof(int32_t))
+			printErrorAndExit(prog_name, "binary graph file is invalid");
+		edges = malloc(LIST_OF_EDGES_SIZE(amount));
+		if(edges == NULL)
+			printErrorAndExit(prog_name, "malloc of list of edges is failed");
+		edges->size = amount;
+		memcpy(edges->list, file + GRAPH_MAGIC_SIZE + sizeof(int32_t), (size_t) amount * sizeof(edge_t));
+		for(int i = 0; i < amount; i++)
+			if(edges->list[i].start < 0 || edges->list[i].end < 0)
+				printErrorAndExit(prog_name, "binary graph file is invalid");
+	}
+	else{
+		const char *end = file + size;
+		size_t amount = 0;
+		for(const char *p = file; (p = memchr(p, '-', (size_t)(end - p))) != NULL; p++)
+			amount++;
+		if(amount > INT_MAX)
+			printErrorAndExit(prog_name, "graph file has too many edges");
+		edges = malloc(LIST_OF_EDGES_SIZE(amount));
+		if(edges == NULL)
+			printErrorAndExit(prog_name, "malloc of list of edges is failed");
+		edges->size = 0;
+		const char *p = file;
+		for(;;){
+			while(p < end && isspace((unsigned char) *p))
+				p++;
+			if(p == end)
+				break;
+			edge_t edge;
+			p = parseVertex(p, end, &edge.start);
+			if(p == end || *p != '-')
+				printErrorAndExit(prog_name, "edge in file is invalid");
+			p = parseVertex(p + 1, end, &edge.end);
+			if(p < end && !isspace((unsigned char) *p))
+				printErrorAndExit(prog_name, "edge in file is invalid");
+			edges->list[edges->size++] = edge;
+		}
+	}
+	munmap((void *) file, size);
+	if(edges->size == 0)
+		printErrorAndExit(prog_name, "requires list of edges");
+	return edges;
+}
+
+/**
+ * @brief Compares two integers for qsort and bsearch.
+ */
+static int compareIntegers(const void *a, const void *b){
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Returns the dense id of an original vertex.
+ *
+ * @param graph The graph whose vertex_ids are searched.
+ * @param vertex The original vertex, which must be part of the graph.
+ * @return The dense id of the vertex.
+ */
+static int denseId(const graph_t *graph, int vertex){
+	int *found = bsearch(&vertex, graph->vertex_ids, graph->vertices_amount, sizeof(int), compareIntegers);
+	return (int)(found - graph->vertex_ids);
+}
+
+/**
+ * @brief Builds compressed adjacency arrays of one direction.
+ *
+ * @details Counting sort of the edges by their start (outgoing) or end (incoming) vertex. A self-loop
+ * is never a backward edge of an order, so it does not take part in any move and is left out.
+ *
+ * @param graph The graph with dense edges.
+ * @param outgoing true to build the out-neighbors, false for the in-neighbors.
+ * @param offsets Receives the newly allocated offsets, vertices_amount + 1 entries.
+ * @param adjacency Receives the newly allocated neighbors.
+ */
+static void createAdjacency(const graph_t *graph, bool outgoing, int **offsets, int **adjacency){
+	int *off = calloc((size_t) graph->vertices_amount + 1, sizeof(int));
+	int *adj = malloc(((size_t) graph->edges_amount + 1) * sizeof(int));
+	if(off == NULL || adj == NULL)
+		printErrorAndExit(prog_name, "malloc of adjacency is failed");
+	const int *from_ids = outgoing ? graph->edge_starts : graph->edge_ends;
+	const int *to_ids = outgoing ? graph->edge_ends : graph->edge_starts;
+	for(int i = 0; i < graph->edges_amount; i++){
+		if(from_ids[i] != to_ids[i])
+			off[from_ids[i] + 1]++;
+	}
+	for(int v = 0; v < graph->vertices_amount; v++)
+		off[v + 1] += off[v];
+	for(int i = 0; i < graph->edges_amount; i++){
+		if(from_ids[i] != to_ids[i])
+			adj[off[from_ids[i]]++] = to_ids[i];
+	}
+	for(int v = graph->vertices_amount; v > 0; v--)
+		off[v] = off[v - 1];
+	off[0] = 0;
+	*offsets = off;
+	*adjacency = adj;
+}
+
+/**
+ * @brief Remaps the vertices of a list of edges to dense ids and builds the adjacency arrays.
+ *
+ * @details Collects all start and end vertices, sorts them and removes duplicates, which gives
+ * vertex_ids in ascending order. Every edge is then translated with a binary search, so the whole
+ * remapping costs O(E log E) instead of a linear search per vertex. The whole graph is a single
+ * component.
+ *
+ * @param graph The graph to initialize.
+ * @param edges The edges with the original vertices.
+ */
+void createGraph(graph_t *graph, const list_of_edges_t *edges){
+	int size = edges->size;
+	graph->edges_amount = size;
+	graph->vertex_ids = malloc(2 * (size_t) size * sizeof(int));
+	graph->edge_starts = malloc(((size_t) size + 1) * sizeof(int));
+	graph->edge_ends = malloc(((size_t) size + 1) * sizeof(int));
+	graph->edge_ids = malloc(((size_t) size + 1) * sizeof(int));
+	if(graph->vertex_ids == NULL || graph->edge_starts == NULL || graph->edge_ends == NULL || graph->edge_ids == NULL)
+		printErrorAndExit(prog_name, "malloc of graph is failed");
+	for(int i = 0; i < size; i++){
+		graph->vertex_ids[2 * i] = edges->list[i].start;
+		graph->vertex_ids[2 * i + 1] = edges->list[i].end;
+	}
+	qsort(graph->vertex_ids, 2 * (size_t) size, sizeof(int), compareIntegers);
+	int amount = 0;
+	for(int i = 0; i < 2 * size; i++){
+		if(amount == 0 || graph->vertex_ids[amount - 1] != graph->vertex_ids[i])
+			graph->vertex_ids[amount++] = graph->vertex_ids[i];
+	}
+	graph->vertices_amount = amount;
+	for(int i = 0; i < size; i++){
+		graph->edge_starts[i] = denseId(graph, edges->list[i].start);
+		graph->edge_ends[i] = denseId(graph, edges->list[i].end);
+		graph->edge_ids[i] = i;
+	}
+	createAdjacency(graph, true, &graph->out_offsets, &graph->out_adjacency);
+	createAdjacency(graph, false, &graph->in_offsets, &graph->in_adjacency);
+	graph->components_amount = 1;
+	graph->component_vertices = malloc(2 * sizeof(int));
+	graph->component_edges = malloc(2 * sizeof(int));
+	if(graph->component_vertices == NULL || graph->component_edges == NULL)
+		printErrorAndExit(prog_name, "malloc of components is failed");
+	graph->component_vertices[0] = 0;
+	graph->component_vertices[1] = graph->vertices_amount;
+	graph->component_edges[0] = 0;
+	graph->component_edges[1] = graph->edges_amount;
+}
+
+/**
+ * @brief Computes the strongly connected components with Tarjan's algorithm.
+ *
+ * @details Iterative, so the depth of the graph is not limited by the call stack. Every vertex
+ * gets the index of its component in component, the components are numbered in the order
+ * Tarjan's algorithm completes them.
+ *
+ * @param graph The graph whose components are computed.
+ * @param component Receives the component of every vertex.
+ * @return The number of components.
+ */
+static int stronglyConnectedComponents(const graph_t *graph, int *component){
+	int n = graph->vertices_amount;
+	int *index = malloc(((size_t) n + 1) * sizeof(int));
+	int *low = malloc(((size_t) n + 1) * sizeof(int));
+	int *edge = malloc(((size_t) n + 1) * sizeof(int));
+	int *call = malloc(((size_t) n + 1) * sizeof(int));
+	int *stack = malloc(((size_t) n + 1) * sizeof(int));
+	if(index == NULL || low == NULL || edge == NULL || call == NULL || stack == NULL)
+		printErrorAndExit(prog_name, "malloc of strongly connected components is failed");
+	for(int v = 0; v < n; v++)
+		index[v] = -1;
+	int counter = 0;
+	int stack_size = 0;
+	int components = 0;
+	for(int root = 0; root < n; root++){
+		if(index[root] != -1)
+			continue;
+		int depth = 0;
+		call[depth++] = root;
+		index[root] = low[root] = counter++;
+		edge[root] = graph->out_offsets[root];
+		stack[stack_size++] = root;
+		component[root] = -1;
+		while(depth > 0){
+			int v = call[depth - 1];
+			if(edge[v] < graph->out_offsets[v + 1]){
+				int w = graph->out_adjacency[edge[v]++];
+				if(index[w] == -1){
+					index[w] = low[w] = counter++;
+					edge[w] = graph->out_offsets[w];
+					stack[stack_size++] = w;
+					component[w] = -1;
+					call[depth++] = w;
+				}
+				else if(component[w] == -1 && index[w] < low[v])
+					low[v] = index[w];
+				continue;
+			}
+			depth--;
+			if(depth > 0 && low[v] < low[call[depth - 1]])
+				low[call[depth - 1]] = low[v];
+			if(low[v] == index[v]){
+				int w;
+				do{
+					w = stack[--stack_size];
+					component[w] = components;
+				}while(w != v);
+				components++;
+			}
+		}
+	}
+	free(index);
+	free(low);
+	free(edge);
+	free(call);
+	free(stack);
+	return components;
+}
+
+/**
+ * @brief Reduces a graph to the edges inside its non-trivial strongly connected components.
+ *
+ * @details An edge between two components is forward in every order that lists the components
+ * in topological order, so it never has to be removed, and a component with a single vertex has no
+ * edge that could be removed (self-loops never go backward). The reduced graph keeps only
+ * components with at least two vertices and only their inner edges. Its vertices are numbered
+ * component by component and its edges are grouped by component, so every component can be
+ * evaluated and improved on its own.
+ *
+ * @param graph The graph created with createGraph.
+ * @param reduced The graph to initialize with the remaining vertices and edges.
+ */
+void reduceGraph(const graph_t *graph, graph_t *reduced){
+	int n = graph->vertices_amount;
+	int *component = malloc(((size_t) n + 1) * sizeof(int));
+	int *new_id = malloc(((size_t) n + 1) * sizeof(int));
+	if(component == NULL || new_id == NULL)
+		printErrorAndExit(prog_name, "malloc of components is failed");
+	int amount = stronglyConnectedComponents(graph, component);
+
+	int *size = calloc((size_t) amount + 1, sizeof(int));
+	int *renumber = malloc(((size_t) amount + 1) * sizeof(int));
+	if(size == NULL || renumber == NULL)
+		printErrorAndExit(prog_name, "malloc of components is failed");
+	for(int v = 0; v < n; v++)
+		size[component[v]]++;
+	int components = 0;
+	for(int c = 0; c < amount; c++)
+		renumber[c] = size[c] >= 2 ? components++ : -1;
+
+	reduced->components_amount = components;
+	reduced->component_vertices = calloc((size_t) components + 1, sizeof(int));
+	reduced->component_edges = calloc((size_t) components + 1, sizeof(int));
+	int *fill = malloc(((size_t) components + 1) * sizeof(int));
+	if(reduced->component_vertices == NULL || reduced->component_edges == NULL || fill == NULL)
+		printErrorAndExit(prog_name, "malloc of components is failed");
+	for(int c = 0; c < amount; c++){
+		if(renumber[c] != -1)
+			reduced->component_vertices[renumber[c] + 1] = size[c];
+	}
+	for(int c = 0; c < components; c++)
+		reduced->component_vertices[c + 1] += reduced->component_vertices[c];
+
+	memcpy(fill, reduced->component_vertices, (size_t) components * sizeof(int));
+	reduced->vertices_amount = reduced->component_vertices[components];
+	reduced->vertex_ids = malloc(((size_t) reduced->vertices_amount + 1) * sizeof(int));
+	if(reduced->vertex_ids == NULL)
+		printErrorAndExit(prog_name, "malloc of reduced graph is failed");
+	for(int v = 0; v < n; v++){
+		int c = component[v] = renumber[component[v]];
+		new_id[v] = c != -1 ? fill[c]++ : -1;
+		if(c != -1)
+			reduced->vertex_ids[new_id[v]] = graph->vertex_ids[v];
+	}
+
+	const int *starts = graph->edge_starts;
+	const int *ends = graph->edge_ends;
+	for(int i = 0; i < graph->edges_amount; i++){
+		int c = component[starts[i]];
+		if(starts[i] != ends[i] && c != -1 && c == component[ends[i]])
+			reduced->component_edges[c + 1]++;
+	}
+	for(int c = 0; c < components; c++)
+		reduced->component_edges[c + 1] += reduced->component_edges[c];
+	memcpy(fill, reduced->component_edges, (size_t) components * sizeof(int));
+	reduced->edges_amount = reduced->component_edges[components];
+	reduced->edge_starts = malloc(((size_t) reduced->edges_amount + 1) * sizeof(int));
+	reduced->edge_ends = malloc(((size_t) reduced->edges_amount + 1) * sizeof(int));
+	reduced->edge_ids = malloc(((size_t) reduced->edges_amount + 1) * sizeof(int));
+	if(reduced->edge_starts == NULL || reduced->edge_ends == NULL || reduced->edge_ids == NULL)
+		printErrorAndExit(prog_name, "malloc of reduced graph is failed");
+	for(int i = 0; i < graph->edges_amount; i++){
+		int c = component[starts[i]];
+		if(starts[i] != ends[i] && c != -1 && c == component[ends[i]]){
+			reduced->edge_starts[fill[c]] = new_id[starts[i]];
+			reduced->edge_ends[fill[c]] = new_id[ends[i]];
+			reduced->edge_ids[fill[c]] = graph->edge_ids[i];
+			fill[c]++;
+		}
+	}
+	createAdjacency(reduced, true, &reduced->out_offsets, &reduced->out_adjacency);
+	createAdjacency(reduced, false, &reduced->in_offsets, &reduced->in_adjacency);
+
+	free(fill);
+	free(size);
+	free(renumber);
+	free(component);
+	free(new_id);
+}
+
+/**
+ * @brief Returns the number of integers of the arrays of a graph stored with storeGraph.
+ */
+static size_t sharedGraphInts(int vertices, int edges, int adjacency, int components){
+	return (size_t) vertices + 2 * (size_t) edges + (size_t) edges + 2 * ((size_t) vertices + 1)
+		+ 2 * (size_t) adjacency + 2 * ((size_t) components + 1);
+}
+
+/**
+ * @brief Returns the size in bytes of a graph stored with storeGraph.
+ *
+ * @param graph The graph to store.
+ * @return The size of the shared_graph_t including its arrays.
+ */
+size_t sharedGraphSize(const graph_t *graph){
+	return sizeof(shared_graph_t) + sharedGraphInts(graph->vertices_amount, graph->edges_amount,
+			graph->out_offsets[graph->vertices_amount], graph->components_amount) * sizeof(int);
+}
+
+/**
+ * @brief Copies ints integers to to and returns the integer after them.
+ */
+static int *storeArray(int *to, const void *from, size_t ints){
+	memcpy(to, from, ints * sizeof(int));
+	return to + ints;
+}
+
+/**
+ * @brief Copies a graph into one block of memory.
+ *
+ * @param graph The graph to store.
+ * @param input_edges Number of edges of the list the graph was created from.
+ * @param shared Memory of sharedGraphSize(graph) bytes.
+ */
+void storeGraph(const graph_t *graph, int input_edges, shared_graph_t *shared){
+	int vertices = graph->vertices_amount;
+	int adjacency = graph->out_offsets[vertices];
+	int components = graph->components_amount;
+	shared->vertices_amount = vertices;
+	shared->edges_amount = graph->edges_amount;
+	shared->adjacency_amount = adjacency;
+	shared->components_amount = components;
+	shared->input_edges = input_edges;
+	int *data = shared->data;
+	data = storeArray(data, graph->vertex_ids, (size_t) vertices);
+	data = storeArray(data, graph->edge_starts, (size_t) graph->edges_amount);
+	data = storeArray(data, graph->edge_ends, (size_t) graph->edges_amount);
+	data = storeArray(data, graph->edge_ids, (size_t) graph->edges_amount);
+	data = storeArray(data, graph->out_offsets, (size_t) vertices + 1);
+	data = storeArray(data, graph->out_adjacency, (size_t) adjacency);
+	data = storeArray(data, graph->in_offsets, (size_t) vertices + 1);
+	data = storeArray(data, graph->in_adjacency, (size_t) adjacency);
+	data = storeArray(data, graph->component_vertices, (size_t) components + 1);
+	storeArray(data, graph->component_edges, (size_t) components + 1);
+}
+
+/**
+ * @brief Lets a graph_t point into a graph stored with storeGraph, without copying it.
+ *
+ * @details The arrays are used in place, so every process that attaches the same shared memory reads
+ * the same copy of the graph.
+ *
+ * @param graph The graph to initialize, it must not be freed with freeGraph.
+ * @param shared The stored graph.
+ * @param size The size of the memory the graph is stored in.
+ */
+void attachGraph(graph_t *graph, const shared_graph_t *shared, size_t size){
+	if(size < sizeof(shared_graph_t) || shared->vertices_amount < 0 || shared->edges_amount < 0
+			|| shared->adjacency_amount < 0 || shared->components_amount < 0
+			|| size < sizeof(shared_graph_t) + sharedGraphInts(shared->vertices_amount, shared->edges_amount,
+				shared->adjacency_amount, shared->components_amount) * sizeof(int))
+		printErrorAndExit(prog_name, "shared graph is invalid");
+	int vertices = shared->vertices_amount;
+	int *data = (int *) shared->data;
+	graph->vertices_amount = vertices;
+	graph->edges_amount = shared->edges_amount;
+	graph->components_amount = shared->components_amount;
+	graph->vertex_ids = data;
+	data += vertices;
+	graph->edge_starts = data;
+	data += graph->edges_amount;
+	graph->edge_ends = data;
+	data += graph->edges_amount;
+	graph->edge_ids = data;
+	data += graph->edges_amount;
+	graph->out_offsets = data;
+	data += vertices + 1;
+	graph->out_adjacency = data;
+	data += shared->adjacency_amount;
+	graph->in_offsets = data;
+	data += vertices + 1;
+	graph->in_adjacency = data;
+	data += shared->adjacency_amount;
+	graph->component_vertices = data;
+	data += graph->components_amount + 1;
+	graph->component_edges = data;
+}
+
+/**
+ * @brief Frees the arrays of a graph.
+ *
+ * @param graph The graph to free.
+ */
+void freeGraph(graph_t *graph){
+	free(graph->vertex_ids);
+	free(graph->edge_starts);
+	free(graph->edge_ends);
+	free(graph->edge_ids);
+	free(graph->out_offsets);
+	free(graph->out_adjacency);
+	free(graph->in_offsets);
+	free(graph->in_adjacency);
+	free(graph->component_vertices);
+	free(graph->component_edges);
+}
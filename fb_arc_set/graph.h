@@ -0,0 +1,131 @@
+/*
+ * @file graph.h
+ * @brief parsing of the graph given as a list of edges or a file, and its copy in the shared memory
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef GRAPH
+#define GRAPH
+
+#include "common.h"
+
+/**
+ * @struct graph_t
+ * @brief Graph with the vertices remapped to dense ids 0 .. vertices_amount - 1.
+ */
+typedef struct{
+	int vertices_amount;	///< Number of different vertices.
+	int edges_amount;	///< Number of edges.
+	int *vertex_ids;	///< Original vertex of every dense id.
+	int *edge_starts;	///< Start vertex of every edge with dense vertex ids, edges are grouped by component.
+	int *edge_ends;		///< End vertex of every edge with dense vertex ids.
+	int *edge_ids;		///< Index of every edge in the list of edges the graph was created from.
+	int *out_offsets;	///< Out-neighbors of v are out_adjacency[out_offsets[v] .. out_offsets[v + 1] - 1].
+	int *out_adjacency;	///< Out-neighbors of all vertices, self-loops are left out.
+	int *in_offsets;	///< In-neighbors of v are in_adjacency[in_offsets[v] .. in_offsets[v + 1] - 1].
+	int *in_adjacency;	///< In-neighbors of all vertices, self-loops are left out.
+	int components_amount;	///< Number of components that are solved independently.
+	int *component_vertices;///< Vertices of component c are component_vertices[c] .. component_vertices[c + 1] - 1.
+	int *component_edges;	///< Edges of component c are component_edges[c] .. component_edges[c + 1] - 1.
+} graph_t;
+
+/**
+ * @brief First bytes of a graph file in the binary format.
+ * @details The magic is followed by the number of edges as a 32 bit integer and the start and end
+ * vertex of every edge as 32 bit integers, all in the byte order of the machine.
+ */
+#define GRAPH_MAGIC "FBAS"
+#define GRAPH_MAGIC_SIZE 4
+
+/**
+ * @struct shared_graph_t
+ * @brief A graph_t stored in one block of memory, so it can be placed in a shared memory object.
+ * @details data holds vertex_ids, edge_starts, edge_ends, edge_ids, out_offsets, out_adjacency, in_offsets,
+ * in_adjacency, component_vertices and component_edges one after another.
+ */
+typedef struct{
+	int vertices_amount;
+	int edges_amount;
+	int adjacency_amount;	///< Number of out-neighbors and of in-neighbors of all vertices.
+	int components_amount;
+	int input_edges;	///< Number of edges of the list the graph was created from.
+	int owner;		///< Process id of the supervisor that stored the graph.
+	int data[];
+} shared_graph_t;
+
+/**
+ * @brief Parses a string into an integer.
+ *
+ * @param str The input string to be converted.
+ * @return The integer value parsed from the string.
+ */
+int parseStringToInteger(char *str);
+
+/**
+ * @brief Parses the edges given as "start-end" arguments.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @param first The index of the first edge argument.
+ * @return A newly allocated list_of_edges_t holding all edges.
+ */
+list_of_edges_t *readListOfEdges(int argc, char *argv[], int first);
+
+/**
+ * @brief Parses the edges of a graph file, either "start-end" words or the binary format.
+ *
+ * @param path The path of the file.
+ * @return A newly allocated list_of_edges_t holding all edges.
+ */
+list_of_edges_t *readListOfEdgesFile(const char *path);
+
+/**
+ * @brief Remaps the vertices of a list of edges to dense ids and builds the adjacency arrays.
+ *
+ * @param graph The graph to initialize.
+ * @param edges The edges with the original vertices.
+ */
+void createGraph(graph_t *graph, const list_of_edges_t *edges);
+
+/**
+ * @brief Reduces a graph to the edges inside its non-trivial strongly connected components.
+ *
+ * @param graph The graph created with createGraph.
+ * @param reduced The graph to initialize with the remaining vertices and edges.
+ */
+void reduceGraph(const graph_t *graph, graph_t *reduced);
+
+/**
+ * @brief Returns the size in bytes of a graph stored with storeGraph.
+ *
+ * @param graph The graph to store.
+ * @return The size of the shared_graph_t including its arrays.
+ */
+size_t sharedGraphSize(const graph_t *graph);
+
+/**
+ * @brief Copies a graph into one block of memory.
+ *
+ * @param graph The graph to store.
+ * @param input_edges Number of edges of the list the graph was created from.
+ * @param shared Memory of sharedGraphSize(graph) bytes.
+ */
+void storeGraph(const graph_t *graph, int input_edges, shared_graph_t *shared);
+
+/**
+ * @brief Lets a graph_t point into a graph stored with storeGraph, without copying it.
+ *
+ * @param graph The graph to initialize, it must not be freed with freeGraph.
+ * @param shared The stored graph.
+ * @param size The size of the memory the graph is stored in.
+ */
+void attachGraph(graph_t *graph, const shared_graph_t *shared, size_t size);
+
+/**
+ * @brief Frees the arrays of a graph.
+ *
+ * @param graph The graph to free.
+ */
+void freeGraph(graph_t *graph);
+
+#endif
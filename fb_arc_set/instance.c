@@ -0,0 +1,104 @@
+/*
+ * @file instance.c
+ * @brief names of the shared memory objects of one supervisor and reclaiming the ones of dead supervisors
+ * @details Every supervisor is an instance with an id, given with -i or taken from its process id. Its
+ * shared memory objects are SHM_NAME.id and SHM_GRAPH_NAME.id, so any number of supervisors run on one
+ * host. Both objects hold the process id of the supervisor that created them in their owner field.
+ * A supervisor that crashed leaves its objects behind; on start, every supervisor looks for objects in
+ * SHM_DIRECTORY whose owner is no longer running and unlinks them. An object without an owner, because
+ * its supervisor is still creating it, is only reclaimed once it is older than RECLAIM_UNOWNED_S.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "instance.h"
+#include "graph.h"
+#include <dirent.h>
+#include <signal.h>
+#include <stddef.h>
+#include <time.h>
+
+#define SHM_DIRECTORY "/dev/shm"
+#define RECLAIM_UNOWNED_S 10
+
+extern char *prog_name;
+
+/**
+ * @brief Sets the id of an instance and the names of its shared memory objects.
+ *
+ * @param instance The instance.
+ * @param id The id, letters, digits, '-' and '_', at most INSTANCE_ID_MAX characters.
+ */
+void instanceInit(instance_t *instance, const char *id){
+	size_t length = strlen(id);
+	if(length == 0 || length > INSTANCE_ID_MAX)
+		printErrorAndExit(prog_name, "instance id is invalid");
+	for(size_t i = 0; i < length; i++){
+		char c = id[i];
+		if(!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_'))
+			printErrorAndExit(prog_name, "instance id is invalid");
+	}
+	strcpy(instance->id, id);
+	snprintf(instance->ring, sizeof(instance->ring), "%s.%s", SHM_NAME, id);
+	snprintf(instance->graph, sizeof(instance->graph), "%s.%s", SHM_GRAPH_NAME, id);
+}
+
+/**
+ * @brief Returns whether a shared memory object belongs to a supervisor that is no longer running.
+ *
+ * @details A supervisor that is running with the same process id as the owner of the object is the
+ * caller itself only if the object is left from an earlier supervisor, because the caller has not
+ * created its objects yet.
+ *
+ * @param name The name of the object, with the leading '/'.
+ * @param offset The offset of the owner field in the object.
+ */
+static bool isStale(const char *name, size_t offset){
+	int fd = shm_open(name, O_RDONLY, 0);
+	if(fd == -1)
+		return false;
+	struct stat object;
+	int owner = 0;
+	bool stale = false;
+	if(fstat(fd, &object) == 0){
+		if((size_t) object.st_size >= offset + sizeof(int) && pread(fd, &owner, sizeof(int), (off_t) offset) == sizeof(int)
+				&& owner > 0)
+			stale = owner == getpid() || (kill(owner, 0) == -1 && errno == ESRCH);
+		else
+			stale = time(NULL) - object.st_mtime >= RECLAIM_UNOWNED_S;
+	}
+	close(fd);
+	return stale;
+}
+
+/**
+ * @brief Unlinks the shared memory objects of all instances whose supervisor is no longer running.
+ *
+ * @details The names in SHM_DIRECTORY lack the leading '/' of the shared memory names. If
+ * SHM_DIRECTORY cannot be read, nothing is reclaimed.
+ *
+ * @return The number of objects unlinked.
+ */
+int instanceReclaim(void){
+	DIR *directory = opendir(SHM_DIRECTORY);
+	if(directory == NULL)
+		return 0;
+	static const char ring_prefix[] = SHM_NAME ".";
+	static const char graph_prefix[] = SHM_GRAPH_NAME ".";
+	int reclaimed = 0;
+	struct dirent *entry;
+	char name[NAME_MAX + 2];
+	while((entry = readdir(directory)) != NULL){
+		size_t offset;
+		if(strncmp(entry->d_name, graph_prefix + 1, sizeof(graph_prefix) - 2) == 0)
+			offset = offsetof(shared_graph_t, owner);
+		else if(strncmp(entry->d_name, ring_prefix + 1, sizeof(ring_prefix) - 2) == 0)
+			offset = offsetof(myshm_t, owner);
+		else
+			continue;
+		snprintf(name, sizeof(name), "/%s", entry->d_name);
+		if(isStale(name, offset) && shm_unlink(name) == 0)
+			reclaimed++;
+	}
+	closedir(directory);
+	return reclaimed;
+}
@@ -0,0 +1,42 @@
+/*
+ * @file instance.h
+ * @brief names of the shared memory objects of one supervisor and reclaiming the ones of dead supervisors
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef INSTANCE
+#define INSTANCE
+
+#include "common.h"
+
+/**
+ * @brief Longest instance id.
+ */
+#define INSTANCE_ID_MAX 32
+
+/**
+ * @struct instance_t
+ * @brief Names of the shared memory objects of one instance, SHM_NAME.id and SHM_GRAPH_NAME.id.
+ */
+typedef struct{
+	char id[INSTANCE_ID_MAX + 1];
+	char ring[sizeof(SHM_NAME) + INSTANCE_ID_MAX + 1];
+	char graph[sizeof(SHM_GRAPH_NAME) + INSTANCE_ID_MAX + 1];
+} instance_t;
+
+/**
+ * @brief Sets the id of an instance and the names of its shared memory objects.
+ *
+ * @param instance The instance.
+ * @param id The id, letters, digits, '-' and '_', at most INSTANCE_ID_MAX characters.
+ */
+void instanceInit(instance_t *instance, const char *id);
+
+/**
+ * @brief Unlinks the shared memory objects of all instances whose supervisor is no longer running.
+ *
+ * @return The number of objects unlinked.
+ */
+int instanceReclaim(void);
+
+#endif
@@ -0,0 +1,369 @@
+/*
+ * @file pool.c
+ * @brief pool of generator processes started, restarted and scaled by the supervisor
+ * @details Every slot of the pool runs one generator pinned to its own CPU. A generator that exits
+ * successfully is finished, for example after the exact search, and its slot stays idle. A generator
+ * that crashes is started again, unless it crashed MAX_CRASHES times in a row right after its start.
+ * Once per window the pool measures the candidates per second of all generators and probes whether
+ * fewer generators reach the same throughput, for example because they share fewer CPUs than there
+ * are slots, and whether one more generator raises it while the solution still improves. A probe
+ * that does not pay off is undone and the pool holds its size for SCALE_HOLD_WINDOWS windows.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#define _GNU_SOURCE
+#include "pool.h"
+#include "ring.h"
+#include <sched.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#define CRASH_WINDOW_MS 1000
+#define MAX_CRASHES 3
+#define SCALE_WINDOW_MS 1000
+#define SCALE_MAX_WINDOW_MS 10000
+#define SCALE_MIN_CANDIDATES 16
+#define SCALE_KEEP 0.9
+#define SCALE_GAIN 0.5
+#define SCALE_HOLD_WINDOWS 5
+#define STOP_TIMEOUT_MS 1000
+#define STOP_POLL_MS 10
+
+extern char *prog_name;
+
+/**
+ * @brief Modes the generator accepts with -m, see getArgumentsSetGenerator in generator.c.
+ */
+static const char *const generator_modes[] = {"random", "local", "greedy", "anneal", "exact"};
+
+/**
+ * @brief Returns the milliseconds that passed since a point in time.
+ */
+static long elapsedMs(const struct timespec *since){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+/**
+ * @brief Returns the number of CPUs the supervisor may run on.
+ *
+ * @return The default size of the pool.
+ */
+int poolDefaultSize(void){
+	cpu_set_t set;
+	if(sched_getaffinity(0, sizeof(set), &set) == -1)
+		return 1;
+	return CPU_COUNT(&set);
+}
+
+/**
+ * @brief Returns whether the generator accepts a mode.
+ */
+static bool validMode(const char *mode){
+	for(size_t i = 0; i < sizeof(generator_modes) / sizeof(generator_modes[0]); i++)
+		if(strcmp(mode, generator_modes[i]) == 0)
+			return true;
+	return false;
+}
+
+/**
+ * @brief Initializes the pool, no generator is started yet.
+ *
+ * @details The slots are pinned to the CPUs the supervisor may run on, in turn. The modes are checked
+ * here, so a typo fails once instead of crashing every generator.
+ *
+ * @param pool The pool to initialize.
+ * @param program Path of the generator executable.
+ * @param size Number of generators.
+ * @param modes Comma separated generator modes, assigned to the slots in turn, may be NULL.
+ * @param checkpoint Checkpoint the generators start from, may be NULL.
+ * @param instance Id of the supervisor's instance.
+ * @param verbose Report every scaling of the pool on stderr.
+ */
+void poolInit(pool_t *pool, const char *program, int size, char *modes, const char *checkpoint,
+		const char *instance, bool verbose){
+	pool->program = program;
+	pool->checkpoint = checkpoint;
+	pool->instance = instance;
+	pool->size = size;
+	pool->active = size;
+	pool->verbose = verbose;
+	pool->workers = calloc((size_t) size + 1, sizeof(worker_t));
+	const char **mode_list = calloc((size_t) size + 1, sizeof(char *));
+	if(pool->workers == NULL || mode_list == NULL)
+		printErrorAndExit(prog_name, "malloc of pool is failed");
+	int modes_amount = 0;
+	for(char *mode = modes != NULL ? strtok(modes, ",") : NULL; mode != NULL && modes_amount < size;
+			mode = strtok(NULL, ",")){
+		if(!validMode(mode))
+			printErrorAndExit(prog_name, "mode is invalid (random, local, greedy, anneal, exact)");
+		mode_list[modes_amount++] = mode;
+	}
+
+	cpu_set_t set;
+	int cpus = 0;
+	int cpu_list[CPU_SETSIZE];
+	if(sched_getaffinity(0, sizeof(set), &set) == 0){
+		for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			if(CPU_ISSET(cpu, &set))
+				cpu_list[cpus++] = cpu;
+	}
+	for(int i = 0; i < size; i++){
+		pool->workers[i].cpu = cpus != 0 ? cpu_list[i % cpus] : -1;
+		pool->workers[i].mode = modes_amount != 0 ? mode_list[i % modes_amount] : NULL;
+	}
+	free(mode_list);
+	pool->candidates = 0;
+	pool->throughput = 0;
+	pool->direction = 0;
+	pool->hold = 0;
+	pool->improvements = 0;
+	clock_gettime(CLOCK_MONOTONIC, &pool->window);
+}
+
+/**
+ * @brief Starts the generator of a slot, pinned to the slot's CPU.
+ *
+ * @details Pinning is done in the child before the exec. If it fails, the generator runs unpinned.
+ * The child asks for SIGTERM when the supervisor dies, so no generator outlives it; if the supervisor
+ * died before that request, the parent is already another process and the child exits.
+ * The generator gets the instance with -i, its mode with -m and the checkpoint with -w.
+ */
+static void startWorker(pool_t *pool, int slot){
+	worker_t *worker = &pool->workers[slot];
+	pid_t parent = getpid();
+	pid_t pid = fork();
+	if(pid == -1)
+		printErrorAndExit(prog_name, "fork of generator is failed");
+	if(pid == 0){
+		if(prctl(PR_SET_PDEATHSIG, SIGTERM) == -1 || getppid() != parent)
+			_exit(EXIT_FAILURE);
+		if(worker->cpu != -1){
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(worker->cpu, &set);
+			sched_setaffinity(0, sizeof(set), &set);
+		}
+		char *args[8];
+		int amount = 0;
+		args[amount++] = (char *) pool->program;
+		args[amount++] = "-i";
+		args[amount++] = (char *) pool->instance;
+		if(worker->mode != NULL){
+			args[amount++] = "-m";
+			args[amount++] = (char *) worker->mode;
+		}
+		if(pool->checkpoint != NULL){
+			args[amount++] = "-w";
+			args[amount++] = (char *) pool->checkpoint;
+		}
+		args[amount] = NULL;
+		execvp(pool->program, args);
+		fprintf(stderr, "%s: exec of %s is failed\n", prog_name, pool->program);
+		_exit(EXIT_FAILURE);
+	}
+	worker->pid = pid;
+	worker->retired = false;
+	clock_gettime(CLOCK_MONOTONIC, &worker->started);
+}
+
+/**
+ * @brief Starts a generator in every slot.
+ *
+ * @param pool The pool.
+ */
+void poolStart(pool_t *pool){
+	for(int i = 0; i < pool->size; i++)
+		startWorker(pool, i);
+}
+
+/**
+ * @brief Collects exited generators and restarts the ones that crashed.
+ *
+ * @details Also starts the generators of slots that became active again when the pool scaled up.
+ * If no generator runs anymore, the slots the pool scaled down are activated again, because no
+ * improvement would ever scale the pool up.
+ *
+ * @param pool The pool.
+ * @return The number of generators that crashed since the last call.
+ */
+int poolReap(pool_t *pool){
+	int crashed = 0;
+	int running = 0;
+	for(int i = 0; i < pool->size; i++){
+		worker_t *worker = &pool->workers[i];
+		if(worker->pid != 0){
+			int status;
+			pid_t result = waitpid(worker->pid, &status, WNOHANG);
+			if(result == 0){
+				running++;
+				continue;
+			}
+			worker->pid = 0;
+			if(result == -1 || worker->retired)
+				continue;
+			if(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS){
+				worker->finished = true;
+				continue;
+			}
+			crashed++;
+			worker->crashes = elapsedMs(&worker->started) < CRASH_WINDOW_MS ? worker->crashes + 1 : 1;
+			if(worker->crashes >= MAX_CRASHES){
+				fprintf(stderr, "%s: generator %d crashed %d times in a row, it is not restarted\n",
+						prog_name, i, worker->crashes);
+				worker->finished = true;
+				continue;
+			}
+		}
+		if(i < pool->active && !worker->finished){
+			startWorker(pool, i);
+			running++;
+		}
+	}
+	if(running == 0 && pool->active < pool->size){
+		pool->active = pool->size;
+		for(int i = 0; i < pool->size; i++)
+			if(pool->workers[i].pid == 0 && !pool->workers[i].finished)
+				startWorker(pool, i);
+	}
+	return crashed;
+}
+
+/**
+ * @brief Returns whether no generator runs and none can be restarted.
+ *
+ * @details Every slot is finished then, because its generator exited successfully or crashed
+ * MAX_CRASHES times in a row.
+ *
+ * @param pool The pool.
+ * @return true if the pool has no generator left.
+ */
+bool poolExhausted(const pool_t *pool){
+	for(int i = 0; i < pool->size; i++)
+		if(pool->workers[i].pid != 0 || !pool->workers[i].finished)
+			return false;
+	return true;
+}
+
+/**
+ * @brief Decides whether the pool probes one generator more or less, or holds its size.
+ *
+ * @details The solution improves if the supervisor read an improvement since the last decision, which
+ * covers the whole time the pool held.
+ *
+ * @param improvements Number of improvements the supervisor has read so far.
+ * @return 1 to start a generator, -1 to stop one, 0 to hold.
+ */
+static int nextProbe(pool_t *pool, int improvements){
+	if(pool->hold > 0){
+		pool->hold--;
+		return 0;
+	}
+	bool improving = improvements > pool->improvements;
+	pool->improvements = improvements;
+	if(pool->direction == 0)
+		pool->direction = improving && pool->active < pool->size ? 1 : -1;
+	if((pool->direction > 0 && (!improving || pool->active == pool->size))
+			|| (pool->direction < 0 && pool->active == 1)){
+		pool->direction = 0;
+		pool->hold = SCALE_HOLD_WINDOWS;
+	}
+	return pool->direction;
+}
+
+/**
+ * @brief Measures the candidate throughput and adapts the number of generators once per window.
+ *
+ * @details The throughput of a window is compared with the one of the window before, which ran with
+ * one generator more or less if the pool changed its size in between. While fewer generators keep
+ * SCALE_KEEP of the throughput, the pool goes on shrinking; while one more generator adds at least
+ * SCALE_GAIN of the average share of a generator and the solution still improves, it goes on growing.
+ * Otherwise the last step is undone and the pool holds for SCALE_HOLD_WINDOWS windows. Then it probes
+ * one more generator if the solution improved while it held, and one less otherwise.
+ * A window is extended up to SCALE_MAX_WINDOW_MS until the active generators counted
+ * SCALE_MIN_CANDIDATES each on average, because a long annealing or exact search counts few
+ * candidates. If they still did not, the throughput is too coarse to compare and a probe is abandoned.
+ * A stopped generator gets SIGTERM and leaves its loop after the current candidate, a started one is
+ * started by poolReap.
+ *
+ * @param pool The pool.
+ * @param myshm A pointer to the shared memory.
+ * @param improvements Number of improvements the supervisor has read so far.
+ */
+void poolScale(pool_t *pool, myshm_t *myshm, int improvements){
+	long window_ms = elapsedMs(&pool->window);
+	if(window_ms < SCALE_WINDOW_MS)
+		return;
+	uint64_t candidates = ringCandidates(myshm) - pool->candidates;
+	bool measured = candidates >= (uint64_t) SCALE_MIN_CANDIDATES * (uint64_t) pool->active;
+	if(!measured && window_ms < SCALE_MAX_WINDOW_MS)
+		return;
+	double throughput = (double) candidates * 1000.0 / (double) window_ms;
+	int step;
+	if(!measured || (pool->direction < 0 && throughput < pool->throughput * SCALE_KEEP)
+			|| (pool->direction > 0 && throughput < pool->throughput * (1 + SCALE_GAIN / (pool->active - 1)))){
+		step = measured ? -pool->direction : 0;
+		pool->direction = 0;
+		pool->hold = SCALE_HOLD_WINDOWS;
+		pool->improvements = improvements;
+	}
+	else
+		step = nextProbe(pool, improvements);
+	if(step < 0){
+		worker_t *worker = &pool->workers[--pool->active];
+		if(worker->pid != 0){
+			worker->retired = true;
+			kill(worker->pid, SIGTERM);
+		}
+	}
+	else if(step > 0)
+		pool->active++;
+	if(step != 0 && pool->verbose)
+		fprintf(stderr, "%s: pool %s to %d generators at %.0f candidates/s\n", prog_name,
+				step > 0 ? "grows" : "shrinks", pool->active, throughput);
+	pool->candidates += candidates;
+	pool->throughput = throughput;
+	clock_gettime(CLOCK_MONOTONIC, &pool->window);
+}
+
+/**
+ * @brief Waits for the generators after the ring was stopped, and kills the ones that do not exit.
+ *
+ * @details The generators get SIGTERM and have STOP_TIMEOUT_MS to leave their loop, then they are killed.
+ *
+ * @param pool The pool.
+ */
+void poolStop(pool_t *pool){
+	for(int i = 0; i < pool->size; i++)
+		if(pool->workers[i].pid != 0)
+			kill(pool->workers[i].pid, SIGTERM);
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(;;){
+		int running = 0;
+		for(int i = 0; i < pool->size; i++){
+			worker_t *worker = &pool->workers[i];
+			if(worker->pid != 0 && waitpid(worker->pid, NULL, WNOHANG) == 0)
+				running++;
+			else
+				worker->pid = 0;
+		}
+		if(running == 0)
+			break;
+		if(elapsedMs(&start) >= STOP_TIMEOUT_MS){
+			for(int i = 0; i < pool->size; i++){
+				if(pool->workers[i].pid != 0){
+					kill(pool->workers[i].pid, SIGKILL);
+					waitpid(pool->workers[i].pid, NULL, 0);
+					pool->workers[i].pid = 0;
+				}
+			}
+			break;
+		}
+		struct timespec poll = {0, STOP_POLL_MS * 1000000L};
+		nanosleep(&poll, NULL);
+	}
+	free(pool->workers);
+}
@@ -0,0 +1,109 @@
+/*
+ * @file pool.h
+ * @brief pool of generator processes started, restarted and scaled by the supervisor
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef POOL
+#define POOL
+
+#include "common.h"
+#include <time.h>
+
+/**
+ * @struct worker_t
+ * @brief One slot of the pool, which runs at most one generator.
+ */
+typedef struct{
+	pid_t pid;			///< Process id of the generator, 0 if the slot is idle.
+	int cpu;			///< CPU the generator is pinned to.
+	const char *mode;		///< Value of the generator's -m option, NULL for its default.
+	bool retired;			///< The supervisor stopped the generator on purpose.
+	bool finished;			///< The generator exited successfully, it is not restarted.
+	int crashes;			///< Number of crashes in a row shortly after the start.
+	struct timespec started;
+} worker_t;
+
+/**
+ * @struct pool_t
+ * @brief Generator processes of the supervisor.
+ * @details Between size and 1 slots are active. The rest is idle, either because the pool scaled down or
+ * because their generator finished or crashed too often.
+ */
+typedef struct{
+	const char *program;		///< Path of the generator executable.
+	const char *checkpoint;		///< Checkpoint the generators start from, NULL for none.
+	const char *instance;		///< Id of the supervisor's instance, given to the generators.
+	int size;			///< Number of slots, the largest number of generators.
+	int active;			///< Number of slots that should run a generator.
+	bool verbose;			///< Every change of active is reported on stderr.
+	worker_t *workers;
+	uint64_t candidates;		///< Number of candidates at the start of the current window.
+	double throughput;		///< Candidates per second of the previous window.
+	int direction;			///< 1 or -1 while the pool probes more or fewer generators, 0 otherwise.
+	int hold;			///< Number of windows to wait before the next probe.
+	int improvements;		///< Number of improvements at the last decision of the pool.
+	struct timespec window;		///< Start of the current window.
+} pool_t;
+
+/**
+ * @brief Returns the number of CPUs the supervisor may run on.
+ *
+ * @return The default size of the pool.
+ */
+int poolDefaultSize(void);
+
+/**
+ * @brief Initializes the pool, no generator is started yet.
+ *
+ * @param pool The pool to initialize.
+ * @param program Path of the generator executable.
+ * @param size Number of generators.
+ * @param modes Comma separated generator modes, assigned to the slots in turn, may be NULL.
+ * @param checkpoint Checkpoint the generators start from, may be NULL.
+ * @param instance Id of the supervisor's instance.
+ * @param verbose Report every scaling of the pool on stderr.
+ */
+void poolInit(pool_t *pool, const char *program, int size, char *modes, const char *checkpoint,
+		const char *instance, bool verbose);
+
+/**
+ * @brief Starts a generator in every slot.
+ *
+ * @param pool The pool.
+ */
+void poolStart(pool_t *pool);
+
+/**
+ * @brief Collects exited generators and restarts the ones that crashed.
+ *
+ * @param pool The pool.
+ * @return The number of generators that crashed since the last call.
+ */
+int poolReap(pool_t *pool);
+
+/**
+ * @brief Returns whether no generator runs and none can be restarted.
+ *
+ * @param pool The pool.
+ * @return true if the pool has no generator left.
+ */
+bool poolExhausted(const pool_t *pool);
+
+/**
+ * @brief Measures the candidate throughput and adapts the number of generators once per window.
+ *
+ * @param pool The pool.
+ * @param myshm A pointer to the shared memory.
+ * @param improvements Number of improvements the supervisor has read so far.
+ */
+void poolScale(pool_t *pool, myshm_t *myshm, int improvements);
+
+/**
+ * @brief Waits for the generators after the ring was stopped, and kills the ones that do not exit.
+ *
+ * @param pool The pool.
+ */
+void poolStop(pool_t *pool);
+
+#endif
@@ -0,0 +1,361 @@
+/*
+ * @file ring.c
+ * @brief multi-producer/single-consumer ring buffer in the shared memory
+ * @details Every slot carries a sequence number. A slot at position pos is free for the
+ * producer that reserved pos when its sequence is pos, and filled for the consumer when its
+ * sequence is pos + 1. Producers reserve positions with a compare-and-swap on write_index,
+ * so two generators never write the same slot. Processes only block in the kernel (futex)
+ * when the ring is full or empty, and only wake the other side if somebody is waiting.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "ring.h"
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <signal.h>
+
+#define WAIT_TIMEOUT_MS 100
+
+/**
+ * @brief Blocks while *addr equals val, at most timeout_ms milliseconds.
+ *
+ * @details The futex is not private, so it works across processes in the shared memory.
+ */
+static void futexWait(unsigned *addr, unsigned val, int timeout_ms){
+	struct timespec timeout = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000};
+	syscall(SYS_futex, addr, FUTEX_WAIT, val, &timeout, NULL, 0);
+}
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+static uint64_t nowNs(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * @brief Wakes at most count processes blocked on addr.
+ */
+static void futexWake(unsigned *addr, int count){
+	syscall(SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+/**
+ * @brief Initializes the indices, futex words and slot sequence numbers of the ring.
+ *
+ * @param myshm A pointer to the shared memory, batch_capacity must already be set.
+ */
+void ringInit(myshm_t *myshm){
+	myshm->read_index = 0;
+	myshm->write_index = 0;
+	myshm->used_futex = 0;
+	myshm->free_futex = 0;
+	myshm->consumer_waiting = 0;
+	myshm->producers_waiting = 0;
+	myshm->stop = false;
+	myshm->optimal = false;
+	myshm->best_bound = INT_MAX;
+	myshm->candidates = 0;
+	myshm->consumer_wait_ns = 0;
+	memset(myshm->producers, 0, sizeof(myshm->producers));
+	for(unsigned i = 0; i < BUFFER_SIZE; i++){
+		*getSlotSequence(myshm, i) = i;
+		*getSlotReserver(myshm, i) = 0;
+	}
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Returns whether the supervisor stopped the ring.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return true if the stop flag is set.
+ */
+bool ringStopped(myshm_t *myshm){
+	return __atomic_load_n(&myshm->stop, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Reserves the next free slot for a generator, blocks while the ring is full.
+ *
+ * @details The slot at pos is free once its sequence equals pos. If it is behind, the
+ * supervisor has not released it yet and the ring is full: the generator registers in
+ * producers_waiting and sleeps on free_futex. The value of free_futex is read before the
+ * slot is checked again, so a release between the check and the sleep makes the futex
+ * return immediately. The time spent sleeping and the reserved slot are counted in the generator's telemetry.
+ * The generator writes its process id into the reserved slot, so the supervisor can tell whether the
+ * reserver of a slot that is never published is still running.
+ * A supervisor that died never releases a slot again, so the generator gives up once the owner of the
+ * shared memory is gone.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param ticket Receives the position of the reserved slot, passed to ringPublish.
+ * @param stats The telemetry of the generator, may be NULL.
+ * @return The batch of the reserved slot, or NULL if the supervisor stopped the ring or died.
+ */
+batch_t *ringReserve(myshm_t *myshm, unsigned *ticket, producer_stats_t *stats){
+	unsigned pos = __atomic_load_n(&myshm->write_index, __ATOMIC_RELAXED);
+	while(!ringStopped(myshm)){
+		unsigned *sequence = getSlotSequence(myshm, pos % BUFFER_SIZE);
+		int diff = (int)(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - pos);
+		if(diff == 0){
+			if(__atomic_compare_exchange_n(&myshm->write_index, &pos, pos + 1, true,
+						__ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+				*ticket = pos;
+				__atomic_store_n(getSlotReserver(myshm, pos % BUFFER_SIZE), (int) getpid(), __ATOMIC_RELEASE);
+				if(stats != NULL)
+					__atomic_add_fetch(&stats->batches, 1, __ATOMIC_RELAXED);
+				return getSlot(myshm, pos % BUFFER_SIZE);
+			}
+		}
+		else if(diff < 0){
+			__atomic_add_fetch(&myshm->producers_waiting, 1, __ATOMIC_SEQ_CST);
+			unsigned val = __atomic_load_n(&myshm->free_futex, __ATOMIC_SEQ_CST);
+			if((int)(__atomic_load_n(sequence, __ATOMIC_SEQ_CST) - pos) < 0 && !ringStopped(myshm)){
+				uint64_t start = nowNs();
+				futexWait(&myshm->free_futex, val, WAIT_TIMEOUT_MS);
+				if(stats != NULL)
+					__atomic_add_fetch(&stats->wait_ns, nowNs() - start, __ATOMIC_RELAXED);
+			}
+			__atomic_sub_fetch(&myshm->producers_waiting, 1, __ATOMIC_SEQ_CST);
+			if(!ringOwnerAlive(myshm))
+				return NULL;
+			pos = __atomic_load_n(&myshm->write_index, __ATOMIC_RELAXED);
+		}
+		else
+			pos = __atomic_load_n(&myshm->write_index, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Makes a slot reserved with ringReserve visible to the supervisor.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param ticket The position returned by ringReserve.
+ */
+void ringPublish(myshm_t *myshm, unsigned ticket){
+	__atomic_store_n(getSlotSequence(myshm, ticket % BUFFER_SIZE), ticket + 1, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&myshm->used_futex, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&myshm->consumer_waiting, __ATOMIC_SEQ_CST))
+		futexWake(&myshm->used_futex, 1);
+}
+
+/**
+ * @brief Returns the next published slot for the supervisor, blocks while the ring is empty.
+ *
+ * @details The time spent sleeping is added to consumer_wait_ns.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param timeout_ms Maximal time to block in milliseconds.
+ * @return The batch of the slot, or NULL on timeout, signal or stop.
+ */
+batch_t *ringPeek(myshm_t *myshm, int timeout_ms){
+	unsigned pos = myshm->read_index;
+	unsigned *sequence = getSlotSequence(myshm, pos % BUFFER_SIZE);
+	if(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) != pos + 1){
+		__atomic_store_n(&myshm->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+		unsigned val = __atomic_load_n(&myshm->used_futex, __ATOMIC_SEQ_CST);
+		if(timeout_ms > 0 && __atomic_load_n(sequence, __ATOMIC_SEQ_CST) != pos + 1 && !ringStopped(myshm)){
+			uint64_t start = nowNs();
+			futexWait(&myshm->used_futex, val, timeout_ms);
+			__atomic_add_fetch(&myshm->consumer_wait_ns, nowNs() - start, __ATOMIC_RELAXED);
+		}
+		__atomic_store_n(&myshm->consumer_waiting, 0, __ATOMIC_SEQ_CST);
+		if(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) != pos + 1)
+			return NULL;
+	}
+	return getSlot(myshm, pos % BUFFER_SIZE);
+}
+
+/**
+ * @brief Hands the slot returned by ringPeek back to the generators.
+ *
+ * @details The reserver is cleared and the sequence is set to the position the slot has in the next
+ * round of the ring.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+void ringRelease(myshm_t *myshm){
+	unsigned pos = myshm->read_index;
+	__atomic_store_n(getSlotReserver(myshm, pos % BUFFER_SIZE), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(getSlotSequence(myshm, pos % BUFFER_SIZE), pos + BUFFER_SIZE, __ATOMIC_RELEASE);
+	myshm->read_index = pos + 1;
+	__atomic_add_fetch(&myshm->free_futex, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&myshm->producers_waiting, __ATOMIC_SEQ_CST))
+		futexWake(&myshm->free_futex, 1);
+}
+
+/**
+ * @brief Sets the stop flag and wakes every process blocked on the ring.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+void ringStop(myshm_t *myshm){
+	__atomic_store_n(&myshm->stop, true, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&myshm->used_futex, 1, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&myshm->free_futex, 1, __ATOMIC_SEQ_CST);
+	futexWake(&myshm->used_futex, INT_MAX);
+	futexWake(&myshm->free_futex, INT_MAX);
+}
+
+/**
+ * @brief Returns whether the supervisor that created the shared memory is still running.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return false once the owner's process is gone.
+ */
+bool ringOwnerAlive(myshm_t *myshm){
+	return !(kill(myshm->owner, 0) == -1 && errno == ESRCH);
+}
+
+/**
+ * @brief Lowers best_bound to size if size is a strict improvement.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param size The size of a new solution.
+ * @return true if best_bound was lowered, false if another solution was at least as good.
+ */
+bool ringLowerBound(myshm_t *myshm, int size){
+	int bound = __atomic_load_n(&myshm->best_bound, __ATOMIC_RELAXED);
+	while(size < bound){
+		if(__atomic_compare_exchange_n(&myshm->best_bound, &bound, size, true,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Returns the size of the best solution published so far.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The current best_bound.
+ */
+int ringBound(myshm_t *myshm){
+	return __atomic_load_n(&myshm->best_bound, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Adds evaluated candidates to the shared counter and to the generator's telemetry.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param stats The telemetry of the generator, may be NULL.
+ * @param amount The number of candidates to add.
+ */
+void ringAddCandidates(myshm_t *myshm, producer_stats_t *stats, uint64_t amount){
+	if(stats != NULL)
+		__atomic_add_fetch(&stats->candidates, amount, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&myshm->candidates, amount, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Returns the number of candidates evaluated by all generators.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The current value of the candidates counter.
+ */
+uint64_t ringCandidates(myshm_t *myshm){
+	return __atomic_load_n(&myshm->candidates, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Marks the solutions published so far as containing a minimal one.
+ *
+ * @details Must be called after the minimal solution was published, so the supervisor finds it in
+ * the ring once it sees the flag.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+void ringSetOptimal(myshm_t *myshm){
+	__atomic_store_n(&myshm->optimal, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Returns whether a generator published a solution that is proven minimal.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return true if the optimal flag is set.
+ */
+bool ringOptimal(myshm_t *myshm){
+	return __atomic_load_n(&myshm->optimal, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Returns the number of slots that are reserved or published and not released yet.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The occupancy of the ring, between 0 and BUFFER_SIZE.
+ */
+unsigned ringFill(myshm_t *myshm){
+	return __atomic_load_n(&myshm->write_index, __ATOMIC_RELAXED) - myshm->read_index;
+}
+
+/**
+ * @brief Returns whether the next slot for the supervisor is reserved by a generator but not published.
+ *
+ * @details If this stays true and ringHeadReserver is no longer running, the generator died between
+ * ringReserve and ringPublish. The supervisor can then hand the slot back with ringRelease without
+ * reading it, otherwise the ring stays blocked.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return true if the slot at read_index is reserved and not published.
+ */
+bool ringHeadReserved(myshm_t *myshm){
+	unsigned pos = myshm->read_index;
+	return ringFill(myshm) != 0 && __atomic_load_n(getSlotSequence(myshm, pos % BUFFER_SIZE), __ATOMIC_ACQUIRE) != pos + 1;
+}
+
+/**
+ * @brief Returns the process id of the generator that reserved the next slot for the supervisor.
+ *
+ * @details The id is written right after the reservation, so a generator that died in between
+ * leaves 0.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The process id, or 0 if it is not known.
+ */
+int ringHeadReserver(myshm_t *myshm){
+	return __atomic_load_n(getSlotReserver(myshm, myshm->read_index % BUFFER_SIZE), __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Claims a telemetry entry for the calling generator.
+ *
+ * @details A free entry is taken with a compare-and-swap on its pid. If every entry is taken, the
+ * entry of a generator that died without ringUnregister is reused.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The telemetry entry, or NULL if MAX_PRODUCERS generators are running.
+ */
+producer_stats_t *ringRegister(myshm_t *myshm){
+	int pid = (int) getpid();
+	for(int pass = 0; pass < 2; pass++){
+		for(int i = 0; i < MAX_PRODUCERS; i++){
+			producer_stats_t *stats = &myshm->producers[i];
+			int owner = __atomic_load_n(&stats->pid, __ATOMIC_RELAXED);
+			if(owner != 0 && (pass == 0 || kill(owner, 0) == 0 || errno != ESRCH))
+				continue;
+			if(__atomic_compare_exchange_n(&stats->pid, &owner, pid, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)){
+				__atomic_store_n(&stats->candidates, 0, __ATOMIC_RELAXED);
+				__atomic_store_n(&stats->wait_ns, 0, __ATOMIC_RELAXED);
+				__atomic_store_n(&stats->batches, 0, __ATOMIC_RELAXED);
+				return stats;
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Frees the telemetry entry of a generator that leaves.
+ *
+ * @param stats The entry returned by ringRegister, may be NULL.
+ */
+void ringUnregister(producer_stats_t *stats){
+	if(stats != NULL)
+		__atomic_store_n(&stats->pid, 0, __ATOMIC_RELEASE);
+}
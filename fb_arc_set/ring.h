@@ -0,0 +1,164 @@
+/*
+ * @file ring.h
+ * @brief multi-producer/single-consumer ring buffer in the shared memory
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef RING
+#define RING
+
+#include "common.h"
+
+/**
+ * @brief Initializes the indices, futex words and slot sequence numbers of the ring.
+ *
+ * @param myshm A pointer to the shared memory, batch_capacity must already be set.
+ */
+void ringInit(myshm_t *myshm);
+
+/**
+ * @brief Reserves the next free slot for a generator, blocks while the ring is full.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param ticket Receives the position of the reserved slot, passed to ringPublish.
+ * @param stats The telemetry of the generator, may be NULL.
+ * @return The batch of the reserved slot, or NULL if the supervisor stopped the ring or died.
+ */
+batch_t *ringReserve(myshm_t *myshm, unsigned *ticket, producer_stats_t *stats);
+
+/**
+ * @brief Makes a slot reserved with ringReserve visible to the supervisor.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param ticket The position returned by ringReserve.
+ */
+void ringPublish(myshm_t *myshm, unsigned ticket);
+
+/**
+ * @brief Returns the next published slot for the supervisor, blocks while the ring is empty.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param timeout_ms Maximal time to block in milliseconds.
+ * @return The batch of the slot, or NULL on timeout, signal or stop.
+ */
+batch_t *ringPeek(myshm_t *myshm, int timeout_ms);
+
+/**
+ * @brief Hands the slot returned by ringPeek back to the generators.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+void ringRelease(myshm_t *myshm);
+
+/**
+ * @brief Sets the stop flag and wakes every process blocked on the ring.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+void ringStop(myshm_t *myshm);
+
+/**
+ * @brief Returns whether the supervisor stopped the ring.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return true if the stop flag is set.
+ */
+bool ringStopped(myshm_t *myshm);
+
+/**
+ * @brief Returns whether the supervisor that created the shared memory is still running.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return false once the owner's process is gone.
+ */
+bool ringOwnerAlive(myshm_t *myshm);
+
+/**
+ * @brief Lowers best_bound to size if size is a strict improvement.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param size The size of a new solution.
+ * @return true if best_bound was lowered, false if another solution was at least as good.
+ */
+bool ringLowerBound(myshm_t *myshm, int size);
+
+/**
+ * @brief Returns the size of the best solution published so far.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The current best_bound.
+ */
+int ringBound(myshm_t *myshm);
+
+/**
+ * @brief Adds evaluated candidates to the shared counter and to the generator's telemetry.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @param stats The telemetry of the generator, may be NULL.
+ * @param amount The number of candidates to add.
+ */
+void ringAddCandidates(myshm_t *myshm, producer_stats_t *stats, uint64_t amount);
+
+/**
+ * @brief Returns the number of candidates evaluated by all generators.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The current value of the candidates counter.
+ */
+uint64_t ringCandidates(myshm_t *myshm);
+
+/**
+ * @brief Marks the solutions published so far as containing a minimal one.
+ *
+ * @param myshm A pointer to the shared memory.
+ */
+void ringSetOptimal(myshm_t *myshm);
+
+/**
+ * @brief Returns whether a generator published a solution that is proven minimal.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return true if the optimal flag is set.
+ */
+bool ringOptimal(myshm_t *myshm);
+
+/**
+ * @brief Returns the number of slots that are reserved or published and not released yet.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The occupancy of the ring, between 0 and BUFFER_SIZE.
+ */
+unsigned ringFill(myshm_t *myshm);
+
+/**
+ * @brief Returns whether the next slot for the supervisor is reserved by a generator but not published.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return true if the slot at read_index is reserved and not published.
+ */
+bool ringHeadReserved(myshm_t *myshm);
+
+/**
+ * @brief Returns the process id of the generator that reserved the next slot for the supervisor.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The process id, or 0 if it is not known.
+ */
+int ringHeadReserver(myshm_t *myshm);
+
+/**
+ * @brief Claims a telemetry entry for the calling generator.
+ *
+ * @param myshm A pointer to the shared memory.
+ * @return The telemetry entry, or NULL if MAX_PRODUCERS generators are running.
+ */
+producer_stats_t *ringRegister(myshm_t *myshm);
+
+/**
+ * @brief Frees the telemetry entry of a generator that leaves.
+ *
+ * @param stats The entry returned by ringRegister, may be NULL.
+ */
+void ringUnregister(producer_stats_t *stats);
+
+#endif
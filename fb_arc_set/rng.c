@@ -0,0 +1,117 @@
+/*
+ * @file rng.c
+ * @brief fast per-process random number generator (xoshiro256**)
+ * @details Replaces rand(), whose global state is seeded with the same time(NULL) in every
+ * generator started in the same second.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "rng.h"
+#include <time.h>
+#include <unistd.h>
+#include <sys/random.h>
+
+/**
+ * @brief splitmix64 step, used to expand a seed to the generator state.
+ *
+ * @param x The splitmix64 state, advanced by one step.
+ * @return The next splitmix64 output.
+ */
+static uint64_t splitmix64(uint64_t *x){
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * @brief Rotates x left by k bits.
+ */
+static inline uint64_t rotl(uint64_t x, int k){
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Seeds the generator from a single 64 bit value.
+ *
+ * @param rng The generator to seed.
+ * @param seed The seed, expanded to the full state with splitmix64.
+ */
+void rngSeed(rng_t *rng, uint64_t seed){
+	for(int i = 0; i < 4; i++)
+		rng->s[i] = splitmix64(&seed);
+}
+
+/**
+ * @brief Seeds the generator so that every process gets a different sequence.
+ *
+ * @details Mixes the process id, the current time in nanoseconds and, if available,
+ * 8 bytes from getrandom. Generators started in the same second therefore still get
+ * different seeds.
+ *
+ * @param rng The generator to seed.
+ */
+void rngSeedUnique(rng_t *rng){
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	uint64_t entropy = 0;
+	if(getrandom(&entropy, sizeof(entropy), GRND_NONBLOCK) != sizeof(entropy))
+		entropy = 0;
+	uint64_t seed = entropy;
+	seed ^= (uint64_t) getpid() * 0x9e3779b97f4a7c15ULL;
+	seed ^= ((uint64_t) ts.tv_sec << 32) ^ (uint64_t) ts.tv_nsec;
+	rngSeed(rng, seed);
+}
+
+/**
+ * @brief Returns the next 64 random bits.
+ *
+ * @param rng The generator.
+ * @return 64 random bits.
+ */
+uint64_t rngNext(rng_t *rng){
+	uint64_t *s = rng->s;
+	uint64_t result = rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+	return result;
+}
+
+/**
+ * @brief Returns an unbiased random number in [0, bound).
+ *
+ * @details Lemire's multiply and shift method: a 32 bit random number times bound gives the
+ * result in the upper half, and the lower half is used to reject the few values that would
+ * make the result biased. No division is needed in the common case.
+ *
+ * @param rng The generator.
+ * @param bound The exclusive upper bound, must be greater than 0.
+ * @return A random number in [0, bound).
+ */
+uint32_t rngBounded(rng_t *rng, uint32_t bound){
+	uint64_t m = (rngNext(rng) >> 32) * (uint64_t) bound;
+	uint32_t low = (uint32_t) m;
+	if(low < bound){
+		uint32_t threshold = -bound % bound;
+		while(low < threshold){
+			m = (rngNext(rng) >> 32) * (uint64_t) bound;
+			low = (uint32_t) m;
+		}
+	}
+	return (uint32_t)(m >> 32);
+}
+
+/**
+ * @brief Returns a random double in [0, 1).
+ *
+ * @param rng The generator.
+ * @return A random double in [0, 1).
+ */
+double rngDouble(rng_t *rng){
+	return (rngNext(rng) >> 11) * 0x1.0p-53;
+}
@@ -0,0 +1,60 @@
+/*
+ * @file rng.h
+ * @brief fast per-process random number generator (xoshiro256**)
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef RNG
+#define RNG
+
+#include <stdint.h>
+
+/**
+ * @struct rng_t
+ * @brief State of a xoshiro256** generator.
+ */
+typedef struct{
+	uint64_t s[4];
+} rng_t;
+
+/**
+ * @brief Seeds the generator from a single 64 bit value.
+ *
+ * @param rng The generator to seed.
+ * @param seed The seed, expanded to the full state with splitmix64.
+ */
+void rngSeed(rng_t *rng, uint64_t seed);
+
+/**
+ * @brief Seeds the generator so that every process gets a different sequence.
+ *
+ * @param rng The generator to seed.
+ */
+void rngSeedUnique(rng_t *rng);
+
+/**
+ * @brief Returns the next 64 random bits.
+ *
+ * @param rng The generator.
+ * @return 64 random bits.
+ */
+uint64_t rngNext(rng_t *rng);
+
+/**
+ * @brief Returns an unbiased random number in [0, bound).
+ *
+ * @param rng The generator.
+ * @param bound The exclusive upper bound, must be greater than 0.
+ * @return A random number in [0, bound).
+ */
+uint32_t rngBounded(rng_t *rng, uint32_t bound);
+
+/**
+ * @brief Returns a random double in [0, 1).
+ *
+ * @param rng The generator.
+ * @return A random double in [0, 1).
+ */
+double rngDouble(rng_t *rng);
+
+#endif
@@ -0,0 +1,240 @@
+/*
+ * @file score.c
+ * @brief counting and collecting the backward edges of vertex orders
+ * @details The edges are stored as two arrays of start and end vertices, so eight edges are two
+ * vector loads. The AVX2 kernels gather the positions of the eight starts and ends, compare them
+ * and count the set bits of the comparison mask. scoreOrders loads every block of edges once and
+ * gathers from several position arrays, which amortizes the edge traffic of large graphs over the
+ * orders. scoreCollect compresses the indices of the backward edges of a block with a permutation
+ * chosen by the comparison mask, the table of permutations is built by scoreInit. The kernels are
+ * compiled for AVX2 with a target attribute and chosen at run time, so the build needs no special
+ * flags and the scalar kernels run on every other CPU.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "score.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCORE_AVX2
+#include <immintrin.h>
+#endif
+
+#define SCORE_LANES 8
+
+static bool use_avx2 = false;
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of an order one edge at a time.
+ */
+static int scoreEdgesScalar(const int *starts, const int *ends, int first, int last, const int *position,
+		int limit){
+	int cost = 0;
+	for(int i = first; i < last && cost < limit; i++)
+		cost += position[starts[i]] > position[ends[i]];
+	return cost;
+}
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of several orders one edge at a time.
+ */
+static void scoreOrdersScalar(const int *starts, const int *ends, int first, int last,
+		const int *const *positions, int orders, int limit, int *costs){
+	for(int k = 0; k < orders; k++)
+		costs[k] = 0;
+	for(int i = first; i < last; i++){
+		bool open = false;
+		for(int k = 0; k < orders; k++){
+			costs[k] += positions[k][starts[i]] > positions[k][ends[i]];
+			open |= costs[k] < limit;
+		}
+		if(!open)
+			break;
+	}
+}
+
+/**
+ * @brief Writes the indices of the backward edges first .. last - 1 of an order one edge at a time.
+ */
+static int scoreCollectScalar(const int *starts, const int *ends, int first, int last, const int *position,
+		int *indices){
+	int amount = 0;
+	for(int i = first; i < last; i++)
+		if(position[starts[i]] > position[ends[i]])
+			indices[amount++] = i;
+	return amount;
+}
+
+#ifdef SCORE_AVX2
+
+/**
+ * @brief Lanes of the backward edges of every comparison mask, packed as eight nibbles.
+ * @details Entry m holds in its nibble j the lane of the j-th set bit of m.
+ */
+static uint32_t compress_table[1 << SCORE_LANES];
+
+/**
+ * @brief Returns the comparison mask of the edges i .. i + 7, bit j is set if edge i + j is backward.
+ */
+__attribute__((target("avx2")))
+static inline int backwardMask(const int *starts, const int *ends, int i, const int *position){
+	__m256i start = _mm256_loadu_si256((const __m256i *)(starts + i));
+	__m256i end = _mm256_loadu_si256((const __m256i *)(ends + i));
+	__m256i backward = _mm256_cmpgt_epi32(_mm256_i32gather_epi32(position, start, 4),
+			_mm256_i32gather_epi32(position, end, 4));
+	return _mm256_movemask_ps(_mm256_castsi256_ps(backward));
+}
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of an order eight edges at a time.
+ */
+__attribute__((target("avx2")))
+static int scoreEdgesAvx2(const int *starts, const int *ends, int first, int last, const int *position,
+		int limit){
+	int cost = 0;
+	int i = first;
+	for(; i + SCORE_LANES <= last && cost < limit; i += SCORE_LANES)
+		cost += __builtin_popcount(backwardMask(starts, ends, i, position));
+	if(cost < limit)
+		cost += scoreEdgesScalar(starts, ends, i, last, position, limit - cost);
+	return cost;
+}
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of several orders, loading every block of edges once.
+ */
+__attribute__((target("avx2")))
+static void scoreOrdersAvx2(const int *starts, const int *ends, int first, int last,
+		const int *const *positions, int orders, int limit, int *costs){
+	int open = orders;
+	for(int k = 0; k < orders; k++)
+		costs[k] = 0;
+	int i = first;
+	for(; i + SCORE_LANES <= last && open > 0; i += SCORE_LANES){
+		__m256i start = _mm256_loadu_si256((const __m256i *)(starts + i));
+		__m256i end = _mm256_loadu_si256((const __m256i *)(ends + i));
+		open = 0;
+		for(int k = 0; k < orders; k++){
+			__m256i backward = _mm256_cmpgt_epi32(_mm256_i32gather_epi32(positions[k], start, 4),
+					_mm256_i32gather_epi32(positions[k], end, 4));
+			costs[k] += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(backward)));
+			open += costs[k] < limit;
+		}
+	}
+	for(; i < last && open > 0; i++){
+		open = 0;
+		for(int k = 0; k < orders; k++){
+			costs[k] += positions[k][starts[i]] > positions[k][ends[i]];
+			open += costs[k] < limit;
+		}
+	}
+}
+
+/**
+ * @brief Writes the indices of the backward edges first .. last - 1 of an order eight edges at a time.
+ *
+ * @details The indices of a block are permuted so that the backward ones come first, then all eight
+ * are stored and the output advances by the number of backward edges, which is why the output needs
+ * SCORE_PADDING integers of room.
+ */
+__attribute__((target("avx2")))
+static int scoreCollectAvx2(const int *starts, const int *ends, int first, int last, const int *position,
+		int *indices){
+	const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+	const __m256i nibble = _mm256_set1_epi32(0xf);
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	int amount = 0;
+	int i = first;
+	for(; i + SCORE_LANES <= last; i += SCORE_LANES){
+		int mask = backwardMask(starts, ends, i, position);
+		if(mask == 0)
+			continue;
+		__m256i permutation = _mm256_and_si256(_mm256_srlv_epi32(
+				_mm256_set1_epi32((int) compress_table[mask]), shifts), nibble);
+		__m256i index = _mm256_add_epi32(_mm256_set1_epi32(i), lanes);
+		_mm256_storeu_si256((__m256i *)(indices + amount), _mm256_permutevar8x32_epi32(index, permutation));
+		amount += __builtin_popcount(mask);
+	}
+	return amount + scoreCollectScalar(starts, ends, i, last, position, indices + amount);
+}
+
+#endif
+
+/**
+ * @brief Chooses the AVX2 kernels if the CPU supports them, otherwise the scalar ones are used.
+ */
+void scoreInit(void){
+#ifdef SCORE_AVX2
+	for(int mask = 0; mask < 1 << SCORE_LANES; mask++){
+		uint32_t entry = 0;
+		int set = 0;
+		for(int lane = 0; lane < SCORE_LANES; lane++)
+			if(mask & (1 << lane))
+				entry |= (uint32_t) lane << (4 * set++);
+		compress_table[mask] = entry;
+	}
+	__builtin_cpu_init();
+	use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of an order.
+ *
+ * @param starts Start vertex of every edge.
+ * @param ends End vertex of every edge.
+ * @param first The first edge.
+ * @param last The edge after the last one.
+ * @param position Position of every vertex.
+ * @param limit The count may stop early once it reaches limit.
+ * @return The number of backward edges, or a number of at least limit.
+ */
+int scoreEdges(const int *starts, const int *ends, int first, int last, const int *position, int limit){
+#ifdef SCORE_AVX2
+	if(use_avx2)
+		return scoreEdgesAvx2(starts, ends, first, last, position, limit);
+#endif
+	return scoreEdgesScalar(starts, ends, first, last, position, limit);
+}
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of several orders in one pass over the edges.
+ *
+ * @param starts Start vertex of every edge.
+ * @param ends End vertex of every edge.
+ * @param first The first edge.
+ * @param last The edge after the last one.
+ * @param positions Position of every vertex in each order.
+ * @param orders Number of orders, at most SCORE_ORDERS.
+ * @param limit The count may stop early once every order reached limit.
+ * @param costs Receives the number of backward edges of each order, or a number of at least limit.
+ */
+void scoreOrders(const int *starts, const int *ends, int first, int last, const int *const *positions,
+		int orders, int limit, int *costs){
+#ifdef SCORE_AVX2
+	if(use_avx2){
+		scoreOrdersAvx2(starts, ends, first, last, positions, orders, limit, costs);
+		return;
+	}
+#endif
+	scoreOrdersScalar(starts, ends, first, last, positions, orders, limit, costs);
+}
+
+/**
+ * @brief Writes the indices of the backward edges 0 .. amount - 1 of an order.
+ *
+ * @param starts Start vertex of every edge.
+ * @param ends End vertex of every edge.
+ * @param amount Number of edges.
+ * @param position Position of every vertex.
+ * @param indices Room for the number of backward edges plus SCORE_PADDING indices.
+ * @return The number of backward edges.
+ */
+int scoreCollect(const int *starts, const int *ends, int amount, const int *position, int *indices){
+#ifdef SCORE_AVX2
+	if(use_avx2)
+		return scoreCollectAvx2(starts, ends, 0, amount, position, indices);
+#endif
+	return scoreCollectScalar(starts, ends, 0, amount, position, indices);
+}
@@ -0,0 +1,65 @@
+/*
+ * @file score.h
+ * @brief counting and collecting the backward edges of vertex orders
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef SCORE
+#define SCORE
+
+/**
+ * @brief Largest number of orders scoreOrders evaluates in one pass over the edges.
+ */
+#define SCORE_ORDERS 4
+
+/**
+ * @brief Number of integers scoreCollect may write after the last index it returns.
+ */
+#define SCORE_PADDING 8
+
+/**
+ * @brief Chooses the AVX2 kernels if the CPU supports them, otherwise the scalar ones are used.
+ */
+void scoreInit(void);
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of an order.
+ *
+ * @param starts Start vertex of every edge.
+ * @param ends End vertex of every edge.
+ * @param first The first edge.
+ * @param last The edge after the last one.
+ * @param position Position of every vertex.
+ * @param limit The count may stop early once it reaches limit.
+ * @return The number of backward edges, or a number of at least limit.
+ */
+int scoreEdges(const int *starts, const int *ends, int first, int last, const int *position, int limit);
+
+/**
+ * @brief Counts the backward edges first .. last - 1 of several orders in one pass over the edges.
+ *
+ * @param starts Start vertex of every edge.
+ * @param ends End vertex of every edge.
+ * @param first The first edge.
+ * @param last The edge after the last one.
+ * @param positions Position of every vertex in each order.
+ * @param orders Number of orders, at most SCORE_ORDERS.
+ * @param limit The count may stop early once every order reached limit.
+ * @param costs Receives the number of backward edges of each order, or a number of at least limit.
+ */
+void scoreOrders(const int *starts, const int *ends, int first, int last, const int *const *positions,
+		int orders, int limit, int *costs);
+
+/**
+ * @brief Writes the indices of the backward edges 0 .. amount - 1 of an order.
+ *
+ * @param starts Start vertex of every edge.
+ * @param ends End vertex of every edge.
+ * @param amount Number of edges.
+ * @param position Position of every vertex.
+ * @param indices Room for the number of backward edges plus SCORE_PADDING indices.
+ * @return The number of backward edges.
+ */
+int scoreCollect(const int *starts, const int *ends, int amount, const int *position, int *indices);
+
+#endif
@@ -0,0 +1,406 @@
+/*
+ * @file search.c
+ * @brief improvement of vertex orders: greedy seeding, local search and simulated annealing
+ * @details The edges that go backward in a vertex order form a feedback arc set. A random order
+ * is a poor start, so these functions either build a greedy order, move single vertices
+ * of an existing order to the position where the fewest of their edges go backward, or
+ * anneal the order with swaps that are evaluated incrementally.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "search.h"
+#include "score.h"
+#include <math.h>
+
+extern char *prog_name;
+
+/**
+ * @brief Allocates the scratch memory of the search for a graph.
+ *
+ * @param search The search to initialize.
+ * @param graph The graph whose vertices are ordered.
+ * @param rng Random number generator used for tie breaking.
+ * @param order Vertex at every position, vertices_amount entries.
+ * @param position Position of every vertex, vertices_amount entries.
+ */
+void searchInit(search_t *search, const graph_t *graph, rng_t *rng, int *order, int *position){
+	size_t n = (size_t) graph->vertices_amount + 1;
+	search->graph = graph;
+	search->rng = rng;
+	search->order = order;
+	search->position = position;
+	search->max_degree = 0;
+	for(int v = 0; v < graph->vertices_amount; v++){
+		int degree = graph->out_offsets[v + 1] - graph->out_offsets[v]
+			+ graph->in_offsets[v + 1] - graph->in_offsets[v];
+		if(degree > search->max_degree)
+			search->max_degree = degree;
+	}
+	search->out_degree = malloc(n * sizeof(int));
+	search->in_degree = malloc(n * sizeof(int));
+	search->next = malloc(n * sizeof(int));
+	search->prev = malloc(n * sizeof(int));
+	search->heads = malloc((2 * (size_t) search->max_degree + 1) * sizeof(int));
+	search->stack = malloc(2 * n * sizeof(int));
+	search->keys = malloc(((size_t) search->max_degree + 1) * sizeof(int));
+	search->best_order = malloc(n * sizeof(int));
+	search->component = malloc(n * sizeof(int));
+	search->stop.ring = NULL;
+	search->stop.signal = NULL;
+	if(search->out_degree == NULL || search->in_degree == NULL || search->next == NULL || search->prev == NULL
+			|| search->heads == NULL || search->stack == NULL || search->keys == NULL || search->best_order == NULL
+			|| search->component == NULL)
+		printErrorAndExit(prog_name, "malloc of search is failed");
+	for(int c = 0; c < graph->components_amount; c++)
+		for(int v = graph->component_vertices[c]; v < graph->component_vertices[c + 1]; v++)
+			search->component[v] = c;
+}
+
+/**
+ * @brief Returns whether the search was asked to stop.
+ */
+static bool searchStopped(const search_t *search){
+	return stopRequested(&search->stop);
+}
+
+/**
+ * @brief Removes a vertex from its bucket of the greedy order.
+ */
+static void bucketRemove(search_t *search, int v, int bucket){
+	if(search->prev[v] != -1)
+		search->next[search->prev[v]] = search->next[v];
+	else
+		search->heads[bucket] = search->next[v];
+	if(search->next[v] != -1)
+		search->prev[search->next[v]] = search->prev[v];
+}
+
+/**
+ * @brief Inserts a vertex at the front of a bucket of the greedy order.
+ */
+static void bucketInsert(search_t *search, int v, int bucket){
+	search->prev[v] = -1;
+	search->next[v] = search->heads[bucket];
+	if(search->heads[bucket] != -1)
+		search->prev[search->heads[bucket]] = v;
+	search->heads[bucket] = v;
+}
+
+/**
+ * @brief Replaces the order with an Eades-Lin-Smyth greedy order.
+ *
+ * @details Sinks are placed at the end, sources at the beginning, and if there are neither,
+ * the vertex with the largest out-degree minus in-degree is placed at the beginning. The
+ * vertices are kept in buckets by that difference, so the whole order costs O(V + E).
+ * The vertices are put into the buckets in random order, which breaks ties differently
+ * in every call.
+ *
+ * @param search The search whose order is replaced.
+ */
+void searchGreedyOrder(search_t *search){
+	const graph_t *graph = search->graph;
+	int n = graph->vertices_amount;
+	int offset = search->max_degree;
+	int *order = search->order;
+	int *removed = search->position;
+	int *sinks = search->stack;
+	int *sources = search->stack + n;
+	int sinks_amount = 0;
+	int sources_amount = 0;
+	for(int b = 0; b <= 2 * offset; b++)
+		search->heads[b] = -1;
+
+	for(int i = 0; i < n; i++)
+		order[i] = i;
+	for(int i = n - 1; i > 0; i--){
+		int j = (int) rngBounded(search->rng, (uint32_t) i + 1);
+		int tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+	for(int i = 0; i < n; i++){
+		int v = order[i];
+		removed[v] = 0;
+		search->out_degree[v] = graph->out_offsets[v + 1] - graph->out_offsets[v];
+		search->in_degree[v] = graph->in_offsets[v + 1] - graph->in_offsets[v];
+		bucketInsert(search, v, search->out_degree[v] - search->in_degree[v] + offset);
+		if(search->out_degree[v] == 0)
+			sinks[sinks_amount++] = v;
+		else if(search->in_degree[v] == 0)
+			sources[sources_amount++] = v;
+	}
+
+	int left = 0;
+	int right = n - 1;
+	int top = 2 * offset;
+	while(left <= right){
+		int v;
+		if(sinks_amount > 0){
+			v = sinks[--sinks_amount];
+			if(removed[v])
+				continue;
+			order[right--] = v;
+		}
+		else if(sources_amount > 0){
+			v = sources[--sources_amount];
+			if(removed[v])
+				continue;
+			order[left++] = v;
+		}
+		else{
+			while(search->heads[top] == -1)
+				top--;
+			v = search->heads[top];
+			order[left++] = v;
+		}
+		removed[v] = 1;
+		bucketRemove(search, v, search->out_degree[v] - search->in_degree[v] + offset);
+		for(int i = graph->out_offsets[v]; i < graph->out_offsets[v + 1]; i++){
+			int w = graph->out_adjacency[i];
+			if(removed[w])
+				continue;
+			int bucket = search->out_degree[w] - search->in_degree[w] + offset;
+			bucketRemove(search, w, bucket);
+			bucketInsert(search, w, bucket + 1);
+			if(bucket + 1 > top)
+				top = bucket + 1;
+			if(--search->in_degree[w] == 0 && search->out_degree[w] != 0)
+				sources[sources_amount++] = w;
+		}
+		for(int i = graph->in_offsets[v]; i < graph->in_offsets[v + 1]; i++){
+			int u = graph->in_adjacency[i];
+			if(removed[u])
+				continue;
+			int bucket = search->out_degree[u] - search->in_degree[u] + offset;
+			bucketRemove(search, u, bucket);
+			bucketInsert(search, u, bucket - 1);
+			if(--search->out_degree[u] == 0)
+				sinks[sinks_amount++] = u;
+		}
+	}
+	for(int i = 0; i < n; i++)
+		search->position[order[i]] = i;
+}
+
+/**
+ * @brief Compares two integers for qsort.
+ */
+static int compareKeys(const void *a, const void *b){
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Moves the vertex at position from to position to and updates the positions in between.
+ */
+static void moveVertex(search_t *search, int from, int to){
+	int *order = search->order;
+	int v = order[from];
+	if(to < from){
+		memmove(order + to + 1, order + to, (size_t)(from - to) * sizeof(int));
+		for(int i = to + 1; i <= from; i++)
+			search->position[order[i]] = i;
+	}
+	else{
+		memmove(order + from, order + from + 1, (size_t)(to - from) * sizeof(int));
+		for(int i = from; i < to; i++)
+			search->position[order[i]] = i;
+	}
+	order[to] = v;
+	search->position[v] = to;
+}
+
+/**
+ * @brief Moves a vertex to the position where the fewest of its edges go backward.
+ *
+ * @details With v taken out of the order, inserting it at gap g makes every in-neighbor at a
+ * position >= g and every out-neighbor at a position < g a backward edge. The neighbor positions
+ * are sorted, encoded as 2 * position + 1 for out-neighbors and 2 * position for in-neighbors,
+ * and swept once, so one vertex costs O(deg log deg) plus the shift of the order.
+ *
+ * @param search The search whose order is improved.
+ * @param v The vertex to move.
+ * @return The number of backward edges removed by the move, 0 if v stays.
+ */
+static int siftVertex(search_t *search, int v){
+	const graph_t *graph = search->graph;
+	int p = search->position[v];
+	int amount = 0;
+	int cost = 0;
+	int current = 0;
+	for(int i = graph->in_offsets[v]; i < graph->in_offsets[v + 1]; i++){
+		int q = search->position[graph->in_adjacency[i]];
+		q -= q > p;
+		search->keys[amount++] = 2 * q;
+		cost++;
+		current += q >= p;
+	}
+	for(int i = graph->out_offsets[v]; i < graph->out_offsets[v + 1]; i++){
+		int q = search->position[graph->out_adjacency[i]];
+		q -= q > p;
+		search->keys[amount++] = 2 * q + 1;
+		current += q < p;
+	}
+	qsort(search->keys, (size_t) amount, sizeof(int), compareKeys);
+
+	int best = cost;
+	int best_gap = 0;
+	for(int i = 0; i < amount; i++){
+		cost += (search->keys[i] & 1) ? 1 : -1;
+		if(i + 1 < amount && (search->keys[i + 1] >> 1) == (search->keys[i] >> 1))
+			continue;
+		if(cost < best){
+			best = cost;
+			best_gap = (search->keys[i] >> 1) + 1;
+		}
+	}
+	if(best >= current)
+		return 0;
+	moveVertex(search, p, best_gap);
+	return current - best;
+}
+
+/**
+ * @brief Improves the order by moving single vertices to their best position.
+ *
+ * @details Every pass visits all vertices in random order and moves each one to its best
+ * position. The search stops at a local optimum, when a whole pass improves nothing, or
+ * after max_passes passes.
+ *
+ * @param search The search whose order is improved.
+ * @param max_passes Maximal number of passes over all vertices, 0 for no limit.
+ * @return The number of backward edges removed from the order.
+ */
+int searchSifting(search_t *search, int max_passes){
+	int n = search->graph->vertices_amount;
+	int *visit = search->stack;
+	int total = 0;
+	for(int i = 0; i < n; i++)
+		visit[i] = i;
+	for(int pass = 0; (max_passes == 0 || pass < max_passes) && !searchStopped(search); pass++){
+		int improvement = 0;
+		for(int i = n - 1; i > 0; i--){
+			int j = (int) rngBounded(search->rng, (uint32_t) i + 1);
+			int tmp = visit[i];
+			visit[i] = visit[j];
+			visit[j] = tmp;
+		}
+		for(int i = 0; i < n; i++)
+			improvement += siftVertex(search, visit[i]);
+		total += improvement;
+		if(improvement == 0)
+			break;
+	}
+	return total;
+}
+
+/**
+ * @brief Counts the backward edges of the current order.
+ *
+ * @param search The search whose order is evaluated.
+ * @return The number of backward edges.
+ */
+int searchCost(const search_t *search){
+	const graph_t *graph = search->graph;
+	return scoreEdges(graph->edge_starts, graph->edge_ends, 0, graph->edges_amount, search->position, INT_MAX);
+}
+
+/**
+ * @brief Change of the number of backward edges if the vertices at positions i < j are swapped.
+ *
+ * @details Only edges of u = order[i] and v = order[j] can change direction, and only if their
+ * other end lies strictly between i and j, or if they connect u and v. The delta therefore
+ * costs O(deg(u) + deg(v)) instead of a pass over all edges.
+ */
+static int swapDelta(const search_t *search, int i, int j){
+	const graph_t *graph = search->graph;
+	const int *position = search->position;
+	int u = search->order[i];
+	int v = search->order[j];
+	int delta = 0;
+	for(int k = graph->out_offsets[u]; k < graph->out_offsets[u + 1]; k++){
+		int q = position[graph->out_adjacency[k]];
+		delta += (q > i && q < j) || q == j;
+	}
+	for(int k = graph->in_offsets[u]; k < graph->in_offsets[u + 1]; k++){
+		int q = position[graph->in_adjacency[k]];
+		delta -= (q > i && q < j) || q == j;
+	}
+	for(int k = graph->out_offsets[v]; k < graph->out_offsets[v + 1]; k++){
+		int q = position[graph->out_adjacency[k]];
+		delta -= q > i && q < j;
+	}
+	for(int k = graph->in_offsets[v]; k < graph->in_offsets[v + 1]; k++){
+		int q = position[graph->in_adjacency[k]];
+		delta += q > i && q < j;
+	}
+	return delta;
+}
+
+/**
+ * @brief Improves the order by simulated annealing over vertex swaps.
+ *
+ * @details Every move picks a random vertex and swaps it with another random vertex of the same
+ * component, since edges never connect two components and a swap across them only moves the
+ * components' vertices without changing a backward edge. Its delta is evaluated in O(deg) with
+ * swapDelta and applied in O(1), since only two positions change. Worse moves are accepted with
+ * probability exp(-delta / temperature). After rounds * V moves the temperature is multiplied
+ * by the cooling factor, until it drops below the final temperature. Only at the end of a
+ * temperature step is the order compared with the saved one and saved if it is better, so the moves
+ * never copy the order; a better order that is reached and left again within a step is not kept.
+ * The saved order is restored at the end.
+ *
+ * @param search The search whose order is improved, it ends with the best order it had at the end of a
+ * temperature step, or the start order if none was better.
+ * @param schedule The cooling schedule.
+ * @return The number of backward edges of the resulting order.
+ */
+int searchAnneal(search_t *search, const anneal_t *schedule){
+	const graph_t *graph = search->graph;
+	int n = graph->vertices_amount;
+	int *order = search->order;
+	int *position = search->position;
+	int cost = searchCost(search);
+	int best = cost;
+	if(n < 2)
+		return cost;
+	memcpy(search->best_order, order, (size_t) n * sizeof(int));
+	uint64_t round_moves = (uint64_t) schedule->rounds * (uint64_t) n;
+	for(double t = schedule->temperature; t >= schedule->final && !searchStopped(search); t *= schedule->cooling){
+		for(uint64_t m = 0; m < round_moves; m++){
+			int u = (int) rngBounded(search->rng, (uint32_t) n);
+			int c = search->component[u];
+			int first = graph->component_vertices[c];
+			int size = graph->component_vertices[c + 1] - first;
+			if(size < 2)
+				continue;
+			int v = first + (int) rngBounded(search->rng, (uint32_t) size - 1);
+			v += v >= u;
+			int i = position[u];
+			int j = position[v];
+			if(i > j){
+				int tmp = i;
+				i = j;
+				j = tmp;
+			}
+			int delta = swapDelta(search, i, j);
+			if(delta > 0 && rngDouble(search->rng) >= exp(-delta / t))
+				continue;
+			int w = order[i];
+			order[i] = order[j];
+			order[j] = w;
+			position[order[i]] = i;
+			position[w] = j;
+			cost += delta;
+		}
+		if(cost < best){
+			best = cost;
+			memcpy(search->best_order, order, (size_t) n * sizeof(int));
+		}
+	}
+	memcpy(order, search->best_order, (size_t) n * sizeof(int));
+	for(int i = 0; i < n; i++)
+		position[order[i]] = i;
+	return best;
+}
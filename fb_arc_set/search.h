@@ -0,0 +1,91 @@
+/*
+ * @file search.h
+ * @brief improvement of vertex orders: greedy seeding, local search and simulated annealing
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef SEARCH
+#define SEARCH
+
+#include "graph.h"
+#include "rng.h"
+
+/**
+ * @struct search_t
+ * @brief Vertex order of a graph together with the scratch memory of the search functions.
+ */
+typedef struct{
+	const graph_t *graph;	///< The graph whose vertices are ordered.
+	rng_t *rng;		///< Random number generator used for tie breaking.
+	int *order;		///< Vertex at every position.
+	int *position;		///< Position of every vertex, inverse of order.
+	int *out_degree;	///< Scratch: remaining out-degree of every vertex.
+	int *in_degree;		///< Scratch: remaining in-degree of every vertex.
+	int *next;		///< Scratch: bucket list links.
+	int *prev;		///< Scratch: bucket list links.
+	int *heads;		///< Scratch: first vertex of every bucket.
+	int *stack;		///< Scratch: sinks and sources waiting to be placed.
+	int *keys;		///< Scratch: neighbor positions of the vertex being moved.
+	int *best_order;	///< Scratch: best order the annealing had at the end of a temperature step.
+	int *component;		///< Component of every vertex.
+	int max_degree;		///< Largest number of neighbors of a vertex.
+	stop_t stop;		///< Long searches return early once one of these flags is set.
+} search_t;
+
+/**
+ * @struct anneal_t
+ * @brief Cooling schedule of the simulated annealing.
+ */
+typedef struct{
+	double temperature;	///< Start temperature.
+	double cooling;		///< Factor the temperature is multiplied with after every round.
+	double final;		///< The annealing ends when the temperature drops below this value.
+	int rounds;		///< Number of moves per temperature, in multiples of the number of vertices.
+} anneal_t;
+
+/**
+ * @brief Allocates the scratch memory of the search for a graph.
+ *
+ * @param search The search to initialize.
+ * @param graph The graph whose vertices are ordered.
+ * @param rng Random number generator used for tie breaking.
+ * @param order Vertex at every position, vertices_amount entries.
+ * @param position Position of every vertex, vertices_amount entries.
+ */
+void searchInit(search_t *search, const graph_t *graph, rng_t *rng, int *order, int *position);
+
+/**
+ * @brief Replaces the order with an Eades-Lin-Smyth greedy order.
+ *
+ * @param search The search whose order is replaced.
+ */
+void searchGreedyOrder(search_t *search);
+
+/**
+ * @brief Improves the order by moving single vertices to their best position.
+ *
+ * @param search The search whose order is improved.
+ * @param max_passes Maximal number of passes over all vertices, 0 for no limit.
+ * @return The number of backward edges removed from the order.
+ */
+int searchSifting(search_t *search, int max_passes);
+
+/**
+ * @brief Counts the backward edges of the current order.
+ *
+ * @param search The search whose order is evaluated.
+ * @return The number of backward edges.
+ */
+int searchCost(const search_t *search);
+
+/**
+ * @brief Improves the order by simulated annealing over vertex swaps.
+ *
+ * @param search The search whose order is improved, it ends with the best order it had at the end of a
+ * temperature step, or the start order if none was better.
+ * @param schedule The cooling schedule.
+ * @return The number of backward edges of the resulting order.
+ */
+int searchAnneal(search_t *search, const anneal_t *schedule);
+
+#endif
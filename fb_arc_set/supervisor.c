@@ -8,14 +8,38 @@
  */
 
 #include "common.h"
+#include "graph.h"
+#include "ring.h"
+#include "pool.h"
+#include "telemetry.h"
+#include "checkpoint.h"
+#include "instance.h"
 #include <signal.h>
+#include <getopt.h>
 
 #define DEFAULT_LIMIT INT_MAX
 #define DEFAULT_DELAY 0
+#define READ_TIMEOUT_MS 100
+#define DRAIN_WAITS 10
+#define RING_STUCK_MS 1000
+#define REPORT_INTERVAL_MS 1000
+#define CHECKPOINT_INTERVAL_MS 5000
 
 char *prog_name;
 volatile sig_atomic_t quit = 0;
+volatile sig_atomic_t report = 0;
 int best_solution = INT_MAX;
+list_of_edges_t *edges;
+list_of_edges_t *best_edges;
+int *best_indices;
+graph_t input_graph;
+instance_t instance;
+int improvements = 0;
+int dead_producers = 0;
+struct timespec start_time;
+pool_t pool;
+int exit_status = EXIT_SUCCESS;
+telemetry_t telemetry;
 
 /**
  * @brief Signal handler function to handle termination signals.
@@ -28,14 +52,43 @@ void handle_sign(int signal){
 	quit = 1;
 }
 
+/**
+ * @brief Signal handler function to request a telemetry report.
+ *
+ * @param signal The signal number received.
+ */
+void handle_report(int signal){
+	report = 1;
+}
+
 /**
  * @struct supervisor_t
  * @brief Structure to represent supervisor configuration parameters.
- * @details The structure includes limit and delay parameters.
+ * @details The structure includes limit and delay parameters, the graph file, NULL if the
+ * edges are given as arguments, and the pool of generators: their number, their executable and
+ * their modes, NULL for the generator's default. verbose prints a telemetry report every second and
+ * every scaling of the pool.
+ * The search also stops after time_limit seconds of search, once no solution improved for stall candidates or
+ * stall_seconds seconds, or once a solution with at most target edges is found; 0, 0, 0 and -1 disable
+ * these. stream prints every new best solution as soon as it is read. checkpoint is the file the best
+ * solution is saved to and the generators start from, NULL for none. instance is the id of the
+ * supervisor's shared memory objects, NULL for one derived from the process id.
  */
 typedef struct{
 	int limit;	
 	int delay;
+	double time_limit;
+	uint64_t stall;
+	double stall_seconds;
+	int target;
+	bool stream;
+	const char *file;
+	int generators;
+	const char *program;
+	char *modes;
+	bool verbose;
+	const char *checkpoint;
+	const char *instance;
 } supervisor_t;
 
 supervisor_t supervisor;
@@ -61,12 +114,80 @@ int readIntOptarg(void){
 	return (int) ret;
 }
 
+/**
+ * @brief Reads a positive number of seconds from the command-line option argument.
+ *
+ * @details Fractions of a second are allowed.
+ *
+ * @param arg The option argument.
+ * @param suffix A character allowed after the number, e.g. 's', or '\0'.
+ * @return The number of seconds.
+ *
+ * @throws Exits the program with an error message if the argument is not a positive number.
+ */
+double readSecondsOptarg(const char *arg, char suffix){
+	char *ptr;
+	double ret = strtod(arg, &ptr);
+	if(ptr == arg || (*ptr != '\0' && (*ptr != suffix || ptr[1] != '\0')) || !(ret > 0))
+		printErrorAndExit(prog_name, "time is invalid");
+	return ret;
+}
+
+/**
+ * @brief Reads the argument of --stall, either a number of candidates or a number of seconds with suffix s.
+ *
+ * @param supervisor A pointer to the supervisor_t structure to store the stall limit.
+ */
+void readStallOptarg(supervisor_t *supervisor){
+	size_t length = strlen(optarg);
+	if(length > 0 && optarg[length - 1] == 's'){
+		supervisor->stall_seconds = readSecondsOptarg(optarg, 's');
+		return;
+	}
+	char *ptr;
+	errno = 0;
+	unsigned long long ret = strtoull(optarg, &ptr, 10);
+	if(ptr == optarg || *ptr != '\0' || errno != 0 || ret == 0 || optarg[0] == '-')
+		printErrorAndExit(prog_name, "stall is invalid");
+	supervisor->stall = ret;
+}
+
+/**
+ * @brief Returns the path of the generator executable next to the supervisor.
+ *
+ * @details If the supervisor was started without a directory, the generator is looked up in PATH as well.
+ *
+ * @param path The path the supervisor was started with.
+ * @return A newly allocated path.
+ */
+char *defaultGenerator(const char *path){
+	const char *slash = strrchr(path, '/');
+	size_t directory = slash != NULL ? (size_t)(slash - path + 1) : 0;
+	char *program = malloc(directory + sizeof("generator"));
+	if(program == NULL)
+		printErrorAndExit(prog_name, "malloc of generator path is failed");
+	memcpy(program, path, directory);
+	strcpy(program + directory, "generator");
+	return program;
+}
+
 /**
  * @brief Parses command-line arguments to set the supervisor configuration
  *
  * @details This function parses the command-line arguments using getopt to set the values of the supervisor
  * structure based on the provided options. It supports the '-n' and '-w' options to set the limit and delay
- * parameters, respectively. If an option is specified more than once, an error is reported and the program exits.
+ * parameters, respectively, and '-f file' to read the graph from a file instead of the arguments.
+ * '-g amount' sets the number of generators the supervisor starts (default: one per CPU, 0 starts none),
+ * '-x program' their executable (default: generator next to the supervisor) and '-m modes' a comma
+ * separated list of generator modes that are given to the generators in turn. '-v' prints a telemetry
+ * report to stderr every second and at the end, and every scaling of the pool.
+ * The long options '--time-limit seconds', '--stall candidates' or '--stall secondss' and '--target size'
+ * add stopping rules, '--stream' prints every new best solution to stdout as soon as it is read.
+ * '-c file' saves the best solution to a checkpoint file every CHECKPOINT_INTERVAL_MS and at the
+ * end; if the file exists at the start, the generators seed their search from it. '-i id' names the
+ * shared memory objects of the supervisor, which the generators are given with their own -i, so
+ * several supervisors run side by side.
+ * If an option is specified more than once, an error is reported and the program exits.
  * The default values are used if an option is not provided.
  *
  * @param argc The number of command-line arguments.
@@ -77,7 +198,25 @@ void getArgrumentsSetSupervisor(int argc, char *argv[], supervisor_t *supervisor
 	int opt;
 	int count_n = 0;
 	int count_w = 0;
-	while((opt = getopt(argc, argv, "n:w:p")) != -1){
+	int count_f = 0;
+	int count_g = 0;
+	int count_x = 0;
+	int count_m = 0;
+	int count_v = 0;
+	int count_c = 0;
+	int count_i = 0;
+	int count_time_limit = 0;
+	int count_stall = 0;
+	int count_target = 0;
+	int count_stream = 0;
+	static const struct option long_options[] = {
+		{"time-limit", required_argument, NULL, 'T'},
+		{"stall", required_argument, NULL, 'S'},
+		{"target", required_argument, NULL, 'K'},
+		{"stream", no_argument, NULL, 'O'},
+		{NULL, 0, NULL, 0}
+	};
+	while((opt = getopt_long(argc, argv, "n:w:f:g:x:m:c:i:vp", long_options, NULL)) != -1){
 		switch(opt){
 			case 'n':{
 				if(count_n == 0){
@@ -97,6 +236,109 @@ void getArgrumentsSetSupervisor(int argc, char *argv[], supervisor_t *supervisor
 					printErrorAndExit(prog_name, "more than one w");
 				break;
 			}
+			case 'f':{
+				if(count_f == 0){
+					count_f++;
+					supervisor->file = optarg;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one f");
+				break;
+			}
+			case 'g':{
+				if(count_g == 0){
+					count_g++;
+					supervisor->generators = readIntOptarg();
+					if(supervisor->generators < 0)
+						printErrorAndExit(prog_name, "number of generators must not be negative");
+				}
+				else
+					printErrorAndExit(prog_name, "more than one g");
+				break;
+			}
+			case 'x':{
+				if(count_x == 0){
+					count_x++;
+					supervisor->program = optarg;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one x");
+				break;
+			}
+			case 'm':{
+				if(count_m == 0){
+					count_m++;
+					supervisor->modes = optarg;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one m");
+				break;
+			}
+			case 'c':{
+				if(count_c == 0){
+					count_c++;
+					supervisor->checkpoint = optarg;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one c");
+				break;
+			}
+			case 'i':{
+				if(count_i == 0){
+					count_i++;
+					supervisor->instance = optarg;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one i");
+				break;
+			}
+			case 'v':{
+				if(count_v == 0){
+					count_v++;
+					supervisor->verbose = true;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one v");
+				break;
+			}
+			case 'T':{
+				if(count_time_limit == 0){
+					count_time_limit++;
+					supervisor->time_limit = readSecondsOptarg(optarg, '\0');
+				}
+				else
+					printErrorAndExit(prog_name, "more than one time-limit");
+				break;
+			}
+			case 'S':{
+				if(count_stall == 0){
+					count_stall++;
+					readStallOptarg(supervisor);
+				}
+				else
+					printErrorAndExit(prog_name, "more than one stall");
+				break;
+			}
+			case 'K':{
+				if(count_target == 0){
+					count_target++;
+					supervisor->target = readIntOptarg();
+					if(supervisor->target < 0)
+						printErrorAndExit(prog_name, "target must not be negative");
+				}
+				else
+					printErrorAndExit(prog_name, "more than one target");
+				break;
+			}
+			case 'O':{
+				if(count_stream == 0){
+					count_stream++;
+					supervisor->stream = true;
+				}
+				else
+					printErrorAndExit(prog_name, "more than one stream");
+				break;
+			}
 			case ':':{
 				printErrorAndExit(prog_name, "option requires argument");
 				break;
@@ -117,12 +359,39 @@ void getArgrumentsSetSupervisor(int argc, char *argv[], supervisor_t *supervisor
 		supervisor->limit = INT_MAX;
 	if(count_w == 0)
 		supervisor->delay = 0;
+	if(count_g == 0)
+		supervisor->generators = poolDefaultSize();
+	if(count_x == 0)
+		supervisor->program = defaultGenerator(argv[0]);
+	if(count_m == 0)
+		supervisor->modes = NULL;
+	if(count_v == 0)
+		supervisor->verbose = false;
+	if(count_c == 0)
+		supervisor->checkpoint = NULL;
+	if(count_i == 0)
+		supervisor->instance = NULL;
+	if(count_time_limit == 0)
+		supervisor->time_limit = 0;
+	if(count_stall == 0){
+		supervisor->stall = 0;
+		supervisor->stall_seconds = 0;
+	}
+	if(count_target == 0)
+		supervisor->target = -1;
+	if(count_stream == 0)
+		supervisor->stream = false;
+	if(count_f == 0)
+		supervisor->file = NULL;
+	else if(optind < argc)
+		printErrorAndExit(prog_name, "edges are given both as file and as arguments");
 }
 
 /**
  * @brief Sets up signal actions for handling termination signals (SIGINT and SIGTERM).
  *
- * @details This function configures signal actions for SIGINT and SIGTERM to call the handle_sign function.
+ * @details This function configures signal actions for SIGINT and SIGTERM to call the handle_sign function,
+ * and for SIGUSR1 to call the handle_report function.
  * It uses sigaction to set the corresponding signal handlers.
  */
 void setUpSignalAction(void){
@@ -133,6 +402,9 @@ void setUpSignalAction(void){
 		printErrorAndExit(prog_name, "sigaction with SIGINT is failed");
 	if (sigaction(SIGTERM, &sa, NULL) == -1)
 		printErrorAndExit(prog_name, "sigaction with SIGTERM is failed");
+	sa.sa_handler = handle_report;
+	if (sigaction(SIGUSR1, &sa, NULL) == -1)
+		printErrorAndExit(prog_name, "sigaction with SIGUSR1 is failed");
 }
 
 /**
@@ -143,48 +415,308 @@ void setUpSignalAction(void){
  *
  * @param edges The list_of_edges to be printed.
  */
-void printListOfEdges(list_of_edges_t edges){
-	int size = edges.size;
+void printListOfEdges(const list_of_edges_t *edges){
+	int size = edges->size;
 	for(int i = 0; i < size; i++){
-		fprintf(stdout, "%d-%d ", edges.list[i].start, edges.list[i].end);
+		fprintf(stdout, "%d-%d ", edges->list[i].start, edges->list[i].end);
 	}
 }
 
 /**
- * @brief Reads and processes a solution from the shared memory buffer.
+ * @brief Returns the seconds that passed since the generators were started.
+ *
+ * @details The time limit, the stall seconds, the --stream lines and the telemetry all count from
+ * start_time, so loading the graph is not part of the search time.
+ */
+double elapsedSeconds(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start_time.tv_sec) + (double)(now.tv_nsec - start_time.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Prints a new best solution as one line to the standard output and flushes it.
  *
- * @details This function reads a solution from the shared memory buffer specified by the provided myshm structure.
- * It checks if the limit parameter of the supervisor has been reached and prints the best solution found.
- * The read_index of the shared memory buffer is updated accordingly.
+ * @details The line is "best size seconds candidates start-end ...", with the seconds since the
+ * generators were started and the candidates evaluated so far, so that a caller can take the best
+ * solution available at its deadline.
  *
  * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ */
+void streamSolution(myshm_t *myshm){
+	fprintf(stdout, "best %d %.3f %llu", best_solution, elapsedSeconds(),
+			(unsigned long long) ringCandidates(myshm));
+	for(int i = 0; i < best_edges->size; i++)
+		fprintf(stdout, " %d-%d", best_edges->list[i].start, best_edges->list[i].end);
+	fprintf(stdout, "\n");
+	fflush(stdout);
+}
+
+/**
+ * @brief Processes one record of a batch.
+ *
+ * @details Generators only record solutions that improved the shared bound, but records of different
+ * generators may arrive out of order, so the size is still compared with the best solution. The
+ * removed edges are only looked up in the list of edges for a new best solution, which is also
+ * logged for the telemetry and printed with --stream. A record without edges, of size other than 0,
+ * was superseded by a later record of the same batch and is skipped; the size and the edges of the
+ * best solution always belong together, even if the batch is not read to its end.
  *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ * @param record The size of the solution, the number of edge indices and the edge indices.
+ * @param producer Process id of the generator that published the record.
  */
-void readSolution(myshm_t *myshm){
-	if(supervisor.limit == 0){
-		fprintf(stdout, "The graph might not be acyclic, best solution removes %d edges.\n", best_solution);
-		quit = 1;
-		return;
-	}
-	list_of_edges_t solution = myshm->buffer[myshm->read_index];
-	if(solution.size == 0){
+void readRecord(myshm_t *myshm, const int *record, int producer){
+	int size = record[0];
+	int count = record[1];
+	if(size == 0){
+		if(supervisor.stream){
+			best_solution = 0;
+			best_edges->size = 0;
+			streamSolution(myshm);
+		}
 		fprintf(stdout, "the graph is acyclic!\n");
 		quit = 1;
 		return;
 	}
 	else{
-		if(solution.size < best_solution){
-			best_solution = solution.size;
+		if(count > 0 && size < best_solution){
+			best_solution = size;
+			improvements++;
+			telemetryImprovement(&telemetry, size, producer);
+			for(int i = 0; i < count; i++){
+				best_indices[i] = record[2 + i];
+				best_edges->list[i] = edges->list[record[2 + i]];
+			}
+			best_edges->size = count;
+			if(supervisor.stream)
+				streamSolution(myshm);
 			//fprintf(stdout, "Solution with %d edges: ", best_solution);
-			//printListOfEdges(solution);
+			//printListOfEdges(best_edges);
 			//fprintf(stdout, "\n");
 		}
 	}
-	supervisor.limit--;
-	myshm->read_index = (myshm->read_index + 1) % BUFFER_SIZE;
+}
+
+/**
+ * @brief Reads and processes all records of a batch from the shared memory buffer.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ * @param batch The batch stored in the current slot of the ring buffer.
+ */
+void readBatch(myshm_t *myshm, const batch_t *batch){
+	int offset = 0;
+	for(int r = 0; r < batch->records && !quit; r++){
+		readRecord(myshm, batch->data + offset, batch->producer);
+		offset += RECORD_INTS(batch->data[offset + 1]);
+	}
+}
+
+/**
+ * @brief Reads the batches that are still in the ring.
+ *
+ * @details Generators publish their batch before they count their candidates, but a generator may have
+ * lowered the shared bound and not published the record yet. While the best solution read is worse than
+ * the shared bound, the ring is waited on up to DRAIN_WAITS times.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ */
+void drainRing(myshm_t *myshm){
+	int waits = 0;
+	while(!quit){
+		bool missing = best_solution > ringBound(myshm);
+		batch_t *batch = ringPeek(myshm, missing ? READ_TIMEOUT_MS : 0);
+		if(batch == NULL){
+			if(!missing || ++waits == DRAIN_WAITS)
+				break;
+			continue;
+		}
+		readBatch(myshm, batch);
+		ringRelease(myshm);
+	}
+}
+
+/**
+ * @brief Checks if one of the stopping rules of the supervisor applies.
+ *
+ * @details The rules are the limit of candidates, the time limit, the stall limits, counted from the
+ * round in which the last improvement was read, and the target size. Once one applies, the solutions
+ * still in the ring are read, then the best solution found is printed and the quit flag is set. If no
+ * solution was found, that is reported and the exit status is set to failure.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ */
+void checkLimit(myshm_t *myshm){
+	static int stall_improvements = -1;
+	static uint64_t stall_candidates;
+	static double stall_since;
+	uint64_t candidates = ringCandidates(myshm);
+	double seconds = elapsedSeconds();
+	if(stall_improvements != improvements){
+		stall_improvements = improvements;
+		stall_candidates = candidates;
+		stall_since = seconds;
+	}
+	if(candidates >= (uint64_t) supervisor.limit
+			|| (supervisor.time_limit > 0 && seconds >= supervisor.time_limit)
+			|| (supervisor.stall > 0 && candidates - stall_candidates >= supervisor.stall)
+			|| (supervisor.stall_seconds > 0 && seconds - stall_since >= supervisor.stall_seconds)
+			|| (supervisor.target >= 0 && best_solution <= supervisor.target)){
+		drainRing(myshm);
+		if(quit)
+			return;
+		if(best_solution != INT_MAX)
+			fprintf(stdout, "The graph might not be acyclic, best solution removes %d edges.\n", best_solution);
+		else{
+			fprintf(stderr, "%s: no solution was found before the search stopped\n", prog_name);
+			exit_status = EXIT_FAILURE;
+		}
+		quit = 1;
+	}
+}
+
+/**
+ * @brief Checks if a generator proved that its solution is minimal.
+ *
+ * @details The generator publishes the minimal solution before it sets the optimal flag, so once
+ * the flag is seen, the solutions still in the ring are read and the best of them is minimal. It is
+ * printed and the quit flag is set.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ */
+void checkOptimal(myshm_t *myshm){
+	if(ringOptimal(myshm)){
+		drainRing(myshm);
+		if(quit)
+			return;
+		fprintf(stdout, "The graph is not acyclic, minimal solution removes %d edges.\n", best_solution);
+		quit = 1;
+	}
+}
+
+/**
+ * @brief Ends the search if the pool has no generator left.
+ *
+ * @details A generator of the exact mode exits after it set the optimal flag, so the flag is checked
+ * first. Otherwise the solutions still in the ring are read, the best solution found is printed if
+ * there is one, an error is reported and the exit status is set to failure.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ */
+void checkExhausted(myshm_t *myshm){
+	if(!poolExhausted(&pool))
+		return;
+	checkOptimal(myshm);
+	if(quit)
+		return;
+	drainRing(myshm);
+	if(quit)
+		return;
+	if(best_solution != INT_MAX)
+		fprintf(stdout, "The graph might not be acyclic, best solution removes %d edges.\n", best_solution);
+	fprintf(stderr, "%s: no generator is running and none can be restarted\n", prog_name);
+	exit_status = EXIT_FAILURE;
+	quit = 1;
+}
+
+/**
+ * @brief Hands back the next slot of the ring if a crashed generator left it reserved.
+ *
+ * @details A generator that dies between ringReserve and ringPublish blocks the ring for good. If the
+ * generator that reserved the next slot is no longer running, the slot is released unread. A generator
+ * that died before it wrote its process id into the slot leaves none; then the slot is only released
+ * if the pool reported a crash that is not handled yet and the slot stays reserved without being
+ * published for RING_STUCK_MS. Once no slot is reserved, every crash is handled.
+ *
+ * @param myshm A pointer to the myshm_t structure representing the shared memory.
+ */
+void recoverRing(myshm_t *myshm){
+	static unsigned stuck_index;
+	static struct timespec stuck_since;
+	static bool stuck = false;
+	if(!ringHeadReserved(myshm)){
+		if(ringFill(myshm) == 0)
+			dead_producers = 0;
+		stuck = false;
+		return;
+	}
+	int reserver = ringHeadReserver(myshm);
+	if(reserver != 0){
+		stuck = false;
+		if(kill(reserver, 0) == -1 && errno == ESRCH){
+			ringRelease(myshm);
+			if(dead_producers > 0)
+				dead_producers--;
+		}
+		return;
+	}
+	if(dead_producers == 0){
+		stuck = false;
+		return;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if(!stuck || stuck_index != myshm->read_index){
+		stuck = true;
+		stuck_index = myshm->read_index;
+		stuck_since = now;
+		return;
+	}
+	long stuck_ms = (now.tv_sec - stuck_since.tv_sec) * 1000 + (now.tv_nsec - stuck_since.tv_nsec) / 1000000;
+	if(stuck_ms >= RING_STUCK_MS){
+		ringRelease(myshm);
+		dead_producers--;
+		stuck = false;
+	}
+}
 
+/**
+ * @brief Saves the best solution to the checkpoint file if it improved since the last save.
+ *
+ * @details A checkpoint that cannot be written is reported, the search goes on.
+ */
+void saveCheckpoint(void){
+	static int saved_improvements = 0;
+	if(supervisor.checkpoint == NULL || improvements == saved_improvements || best_edges->size == 0)
+		return;
+	if(!checkpointSave(supervisor.checkpoint, &input_graph, best_indices, best_edges->size))
+		fprintf(stderr, "%s: checkpoint %s cannot be written\n", prog_name, supervisor.checkpoint);
+	saved_improvements = improvements;
 }
 
+/**
+ * @brief Builds the graph the generators search on and stores it in its own shared memory object.
+ *
+ * @details The graph is remapped to dense ids and reduced to its non-trivial strongly connected
+ * components once, here. The generators map the object read-only and use the arrays in place, so
+ * starting a generator costs the same for every graph size. The graph before the reduction is kept
+ * in input_graph for the checkpoints.
+ */
+void storeSharedGraph(void){
+	graph_t graph;
+	createGraph(&input_graph, edges);
+	reduceGraph(&input_graph, &graph);
+	if(supervisor.checkpoint == NULL)
+		freeGraph(&input_graph);
+	size_t size = sharedGraphSize(&graph);
+	int fd = shm_open(instance.graph, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fd == -1 && errno == EEXIST)
+		printErrorAndExit(prog_name, "instance is used by a running supervisor");
+	if(fd == -1)
+		printErrorAndExit(prog_name, "shm_open of graph is failed");
+	if(ftruncate(fd, size) < 0)
+		printErrorAndExit(prog_name, "ftruncate of graph is failed");
+	shared_graph_t *shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(shared == MAP_FAILED)
+		printErrorAndExit(prog_name, "mmap of graph is failed");
+	storeGraph(&graph, edges->size, shared);
+	shared->owner = (int) getpid();
+	freeGraph(&graph);
+	if(munmap(shared, size) == -1)
+		printErrorAndExit(prog_name, "munmap of graph is failed");
+	if(close(fd) == -1)
+		printErrorAndExit(prog_name, "close of graph fd is failed");
+}
 
 /**
  * @brief The main function of the program.
@@ -193,11 +725,22 @@ void readSolution(myshm_t *myshm){
  * 1. Sets the global variable `prog_name` to the program's name.
  * 2. Parses command-line arguments to set the supervisor configuration using getArgrumentsSetSupervisor.
  * 3. Sets up signal actions for handling termination signals (SIGINT and SIGTERM) using setUpSignalAction.
- * 4. Creates a shared memory object and maps it to the process's address space using shm_open and mmap.
- * 5. Initializes the shared memory structure and semaphores for synchronization.
- * 6. Waits for the specified delay time.
- * 7. Enters a loop to read solutions from the shared memory until the termination signal is received.
- * 8. Closes and unlinks semaphores, unmaps shared memory, unlinks shared memory object, and closes the shared memory descriptor.
+ * 4. Reclaims the shared memory objects of supervisors that are no longer running and sets up the pool
+ *    of generators, which checks their modes. Reads the graph
+ *    from the file or the remaining arguments, reduces it to its non-trivial strongly
+ *    connected components and stores it in a shared memory object of the instance for the generators.
+ *    Then creates a shared memory object sized for the ring and maps it to the process's address space
+ *    using shm_open and mmap.
+ * 5. Initializes the shared memory structure and the ring buffer.
+ * 6. Starts the pool of generators and waits for the specified delay time.
+ * 7. Enters a loop to read batches of solutions from the ring buffer, all published batches per wakeup,
+ *    until the termination signal is received,
+ *    a stopping rule applies or a generator proved a solution minimal. Meanwhile crashed generators are
+ *    restarted, the pool is scaled and the checkpoint is saved. If no generator is left, the best
+ *    solution is printed and the supervisor exits with failure. A telemetry report is printed on SIGUSR1, and with -v every
+ *    REPORT_INTERVAL_MS and at the end.
+ * 8. Stops the ring, which wakes all generators, waits for the generators of the pool, unmaps shared memory, unlinks the shared memory objects,
+ *    and closes the shared memory descriptor.
  *
  * @param argc The number of command-line arguments.
  * @param argv An array of command-line argument strings.
@@ -210,66 +753,108 @@ int main(int argc, char *argv[]){
 
 	setUpSignalAction();
 
-	int shmfd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0600);
+	char pid_id[INSTANCE_ID_MAX + 1];
+	snprintf(pid_id, sizeof(pid_id), "%d", (int) getpid());
+	instanceInit(&instance, supervisor.instance != NULL ? supervisor.instance : pid_id);
+	int reclaimed = instanceReclaim();
+	if(reclaimed > 0)
+		fprintf(stderr, "%s: reclaimed %d shared memory objects of supervisors that are not running\n",
+				prog_name, reclaimed);
+	if(supervisor.generators == 0 || supervisor.verbose)
+		fprintf(stderr, "%s: instance %s\n", prog_name, instance.id);
+
+	if(supervisor.generators > 0){
+		bool resume = supervisor.checkpoint != NULL && access(supervisor.checkpoint, R_OK) == 0;
+		poolInit(&pool, supervisor.program, supervisor.generators, supervisor.modes,
+				resume ? supervisor.checkpoint : NULL, instance.id, supervisor.verbose);
+	}
+
+	edges = supervisor.file != NULL ? readListOfEdgesFile(supervisor.file) : readListOfEdges(argc, argv, optind);
+	storeSharedGraph();
+	best_edges = malloc(LIST_OF_EDGES_SIZE(edges->size));
+	best_indices = malloc(((size_t) edges->size + 1) * sizeof(int));
+	if(best_edges == NULL || best_indices == NULL)
+		printErrorAndExit(prog_name, "malloc of best solution is failed");
+	best_edges->size = 0;
+	int batch_capacity = RECORD_INTS(edges->size) > BATCH_INTS ? RECORD_INTS(edges->size) : BATCH_INTS;
+	size_t shm_size = SHM_SIZE(batch_capacity);
+
+	int shmfd = shm_open(instance.ring, O_CREAT | O_EXCL | O_RDWR, 0600);
 	
+	if(shmfd == -1 && errno == EEXIST)
+		printErrorAndExit(prog_name, "instance is used by a running supervisor");
 	if(shmfd == -1)
 		printErrorAndExit(prog_name, "semaphore open is failed");
-	if(ftruncate(shmfd, sizeof(myshm_t)) < 0)
+	if(ftruncate(shmfd, shm_size) < 0)
 		printErrorAndExit(prog_name, "ftruncate is failed");
-	myshm_t *myshm = mmap(NULL, sizeof(*myshm), PROT_READ | PROT_WRITE, MAP_SHARED, shmfd, 0);
+	myshm_t *myshm = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shmfd, 0);
 
 	if(myshm == MAP_FAILED)
 		printErrorAndExit(prog_name, "mmap is failed");
 
-	myshm->read_index = 0;
-	myshm->write_index = 0;
-	myshm->stop = false;
-	
-	sem_t *free_sem = sem_open("/free_sem", O_CREAT, 0600, BUFFER_SIZE);
-	if(free_sem == SEM_FAILED){
-		sem_unlink("/free_sem");
-		        sem_unlink("/used_sem");
-		printErrorAndExit(prog_name, "free sem_open is failed");
-	}
-	sem_t *used_sem = sem_open("/used_sem", O_CREAT, 0600, 0);
-	if(used_sem == SEM_FAILED)
-		printErrorAndExit(prog_name, "used sem_open is failed");
+	myshm->owner = (int) getpid();
+	myshm->batch_capacity = batch_capacity;
+	ringInit(myshm);
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	telemetryInit(&telemetry, &start_time);
+	double checkpoint_time = elapsedSeconds();
+
+	if(supervisor.generators > 0)
+		poolStart(&pool);
 
 	sleep(supervisor.delay);
 
 	while(!quit){
-		if(sem_wait(used_sem) == -1){
-			if(errno == EINTR){
-				myshm->stop = true;
-				printErrorAndExit(prog_name, "interrupted by a signal");
-
-			}
-			printErrorAndExit(prog_name, "sem_wait is failed");
+		batch_t *batch = ringPeek(myshm, READ_TIMEOUT_MS);
+		while(batch != NULL && !quit){
+			readBatch(myshm, batch);
+			ringRelease(myshm);
+			batch = ringPeek(myshm, 0);
+		}
+		if(!quit)
+			checkOptimal(myshm);
+		if(!quit)
+			checkLimit(myshm);
+		if(!quit && supervisor.generators > 0){
+			dead_producers += poolReap(&pool);
+			checkExhausted(myshm);
+		}
+		if(!quit && supervisor.generators > 0){
+			poolScale(&pool, myshm, improvements);
+			recoverRing(myshm);
+		}
+		telemetrySample(&telemetry, myshm);
+		if(report || (supervisor.verbose && telemetrySinceReport(&telemetry) >= REPORT_INTERVAL_MS)){
+			report = 0;
+			telemetryReport(&telemetry, myshm, best_solution, stderr);
+		}
+		if(elapsedSeconds() - checkpoint_time >= CHECKPOINT_INTERVAL_MS / 1000.0){
+			checkpoint_time = elapsedSeconds();
+			saveCheckpoint();
 		}
-		
-		readSolution(myshm);
-
-		if(quit)
-			break;
-		if(sem_post(free_sem) == -1)
-			printErrorAndExit(prog_name, "sem_post is failed");
 	}
-	myshm->stop = true;
-
-	if(sem_close(free_sem) == -1)
-		printErrorAndExit(prog_name, "sem_close is failed");
-	if(sem_close(used_sem) == -1)
-		printErrorAndExit(prog_name, "sem_close is failed");
-	sem_unlink("/free_sem");
-	sem_unlink("/used_sem");
+	saveCheckpoint();
+	if(supervisor.verbose)
+		telemetryReport(&telemetry, myshm, best_solution, stderr);
+	ringStop(myshm);
+	if(supervisor.generators > 0)
+		poolStop(&pool);
 
-	if(munmap(myshm, sizeof(* myshm)) == -1)
+	if(munmap(myshm, shm_size) == -1)
 		printErrorAndExit(prog_name, "munmap is failed");
-	if(shm_unlink(SHM_NAME) == -1)
+	if(shm_unlink(instance.ring) == -1)
 		printErrorAndExit(prog_name, "shm_unlink is failed");
+	if(shm_unlink(instance.graph) == -1)
+		printErrorAndExit(prog_name, "shm_unlink of graph is failed");
 	if(close(shmfd) == -1)
 		printErrorAndExit(prog_name, "close of fd is failed");
-	return EXIT_SUCCESS;
+	free(edges);
+	free(best_edges);
+	free(best_indices);
+	if(supervisor.checkpoint != NULL)
+		freeGraph(&input_graph);
+	telemetryFree(&telemetry);
+	return exit_status;
 
 	
 }
@@ -0,0 +1,154 @@
+/*
+ * @file telemetry.c
+ * @brief throughput, ring occupancy and wait time of the generators and the supervisor
+ * @details Every generator claims an entry of the shared memory with ringRegister and counts its
+ * candidates, its published batches and the time it was blocked on a full ring there. The supervisor
+ * counts the time it was blocked on an empty ring. A report prints the differences to the counters of
+ * the previous report, so the rates are those of the interval between two reports. The ring occupancy
+ * is sampled on every round of the supervisor's loop and averaged over the interval.
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#include "telemetry.h"
+#include "ring.h"
+
+extern char *prog_name;
+
+/**
+ * @brief Returns the seconds between two points in time.
+ */
+static double secondsBetween(const struct timespec *from, const struct timespec *to){
+	return (double)(to->tv_sec - from->tv_sec) + (double)(to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Initializes the telemetry.
+ *
+ * @details The supervisor passes the start of its own clock, so the times of the reports and of the
+ * improvement log match the ones of --stream.
+ *
+ * @param telemetry The telemetry to initialize.
+ * @param start The time the generators were started, all times of the telemetry count from it.
+ */
+void telemetryInit(telemetry_t *telemetry, const struct timespec *start){
+	memset(telemetry, 0, sizeof(*telemetry));
+	telemetry->start = *start;
+	telemetry->last = telemetry->start;
+}
+
+/**
+ * @brief Samples the ring occupancy.
+ *
+ * @param telemetry The telemetry.
+ * @param myshm A pointer to the shared memory.
+ */
+void telemetrySample(telemetry_t *telemetry, myshm_t *myshm){
+	telemetry->fill_sum += ringFill(myshm);
+	telemetry->fill_samples++;
+}
+
+/**
+ * @brief Appends a new best solution to the improvement log.
+ *
+ * @details The log grows by doubling its capacity.
+ *
+ * @param telemetry The telemetry.
+ * @param size Size of the new best solution.
+ * @param producer Process id of the generator that found it.
+ */
+void telemetryImprovement(telemetry_t *telemetry, int size, int producer){
+	if(telemetry->log_size == telemetry->log_capacity){
+		int capacity = telemetry->log_capacity != 0 ? 2 * telemetry->log_capacity : 64;
+		improvement_t *log = realloc(telemetry->log, (size_t) capacity * sizeof(improvement_t));
+		if(log == NULL)
+			printErrorAndExit(prog_name, "realloc of improvement log is failed");
+		telemetry->log = log;
+		telemetry->log_capacity = capacity;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	improvement_t *entry = &telemetry->log[telemetry->log_size++];
+	entry->seconds = secondsBetween(&telemetry->start, &now);
+	entry->size = size;
+	entry->producer = producer;
+}
+
+/**
+ * @brief Returns the milliseconds since the last report.
+ *
+ * @param telemetry The telemetry.
+ * @return The milliseconds since the last report.
+ */
+long telemetrySinceReport(const telemetry_t *telemetry){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long)(secondsBetween(&telemetry->last, &now) * 1000);
+}
+
+/**
+ * @brief Prints the rates since the last report and the improvements that were not printed yet.
+ *
+ * @details A generator whose entry changed its process id since the last report, because it was
+ * restarted, is counted from zero. The wait times are given as share of the interval.
+ *
+ * @param telemetry The telemetry.
+ * @param myshm A pointer to the shared memory.
+ * @param best Size of the best solution so far.
+ * @param out The stream to print to.
+ */
+void telemetryReport(telemetry_t *telemetry, myshm_t *myshm, int best, FILE *out){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double seconds = secondsBetween(&telemetry->last, &now);
+	if(seconds <= 0)
+		seconds = 1e-9;
+	uint64_t candidates = ringCandidates(myshm);
+	uint64_t consumer_wait = __atomic_load_n(&myshm->consumer_wait_ns, __ATOMIC_RELAXED);
+	double fill = telemetry->fill_samples != 0 ? (double) telemetry->fill_sum / telemetry->fill_samples : 0;
+
+	fprintf(out, "[%.1fs] %.0f candidates/s, ring fill %.1f/%d, supervisor waits %.0f%%, best %d\n",
+			secondsBetween(&telemetry->start, &now), (candidates - telemetry->candidates) / seconds,
+			fill, BUFFER_SIZE, (consumer_wait - telemetry->consumer_wait_ns) / 1e7 / seconds,
+			best == INT_MAX ? -1 : best);
+	for(int i = 0; i < MAX_PRODUCERS; i++){
+		producer_stats_t current;
+		current.pid = __atomic_load_n(&myshm->producers[i].pid, __ATOMIC_ACQUIRE);
+		current.candidates = __atomic_load_n(&myshm->producers[i].candidates, __ATOMIC_RELAXED);
+		current.wait_ns = __atomic_load_n(&myshm->producers[i].wait_ns, __ATOMIC_RELAXED);
+		current.batches = __atomic_load_n(&myshm->producers[i].batches, __ATOMIC_RELAXED);
+		producer_stats_t *previous = &telemetry->producers[i];
+		if(previous->pid != current.pid || previous->candidates > current.candidates){
+			previous->candidates = 0;
+			previous->wait_ns = 0;
+			previous->batches = 0;
+		}
+		if(current.pid != 0)
+			fprintf(out, "  generator %d: %.0f candidates/s, waits %.0f%%, %llu batches\n", current.pid,
+					(current.candidates - previous->candidates) / seconds,
+					(current.wait_ns - previous->wait_ns) / 1e7 / seconds,
+					(unsigned long long)(current.batches - previous->batches));
+		*previous = current;
+	}
+	for(; telemetry->log_reported < telemetry->log_size; telemetry->log_reported++){
+		improvement_t *entry = &telemetry->log[telemetry->log_reported];
+		fprintf(out, "  improvement at %.3fs: %d edges by generator %d\n", entry->seconds, entry->size,
+				entry->producer);
+	}
+	fflush(out);
+
+	telemetry->last = now;
+	telemetry->candidates = candidates;
+	telemetry->consumer_wait_ns = consumer_wait;
+	telemetry->fill_sum = 0;
+	telemetry->fill_samples = 0;
+}
+
+/**
+ * @brief Frees the improvement log.
+ *
+ * @param telemetry The telemetry.
+ */
+void telemetryFree(telemetry_t *telemetry){
+	free(telemetry->log);
+	telemetry->log = NULL;
+}
@@ -0,0 +1,91 @@
+/*
+ * @file telemetry.h
+ * @brief throughput, ring occupancy and wait time of the generators and the supervisor
+ * @author Vorobeva Aksinia 12044614
+ * @date 11.12.2023
+ */
+#ifndef TELEMETRY
+#define TELEMETRY
+
+#include "common.h"
+#include <time.h>
+
+/**
+ * @struct improvement_t
+ * @brief One entry of the improvement log.
+ */
+typedef struct{
+	double seconds;		///< Seconds since the start of the telemetry.
+	int size;		///< Size of the new best solution.
+	int producer;		///< Process id of the generator that found it.
+} improvement_t;
+
+/**
+ * @struct telemetry_t
+ * @brief Counters of the last report, to print the rates since then, and the improvement log.
+ */
+typedef struct{
+	struct timespec start;			///< Time the generators were started.
+	struct timespec last;			///< Time of the last report.
+	uint64_t candidates;			///< Candidates of all generators at the last report.
+	uint64_t consumer_wait_ns;		///< Wait time of the supervisor at the last report.
+	uint64_t fill_sum;			///< Sum of the sampled ring occupancy since the last report.
+	uint64_t fill_samples;			///< Number of samples since the last report.
+	producer_stats_t producers[MAX_PRODUCERS];	///< Telemetry of the generators at the last report.
+	improvement_t *log;
+	int log_size;
+	int log_capacity;
+	int log_reported;			///< Number of improvements already printed.
+} telemetry_t;
+
+/**
+ * @brief Initializes the telemetry.
+ *
+ * @param telemetry The telemetry to initialize.
+ * @param start The time the generators were started, all times of the telemetry count from it.
+ */
+void telemetryInit(telemetry_t *telemetry, const struct timespec *start);
+
+/**
+ * @brief Samples the ring occupancy.
+ *
+ * @param telemetry The telemetry.
+ * @param myshm A pointer to the shared memory.
+ */
+void telemetrySample(telemetry_t *telemetry, myshm_t *myshm);
+
+/**
+ * @brief Appends a new best solution to the improvement log.
+ *
+ * @param telemetry The telemetry.
+ * @param size Size of the new best solution.
+ * @param producer Process id of the generator that found it.
+ */
+void telemetryImprovement(telemetry_t *telemetry, int size, int producer);
+
+/**
+ * @brief Returns the milliseconds since the last report.
+ *
+ * @param telemetry The telemetry.
+ * @return The milliseconds since the last report.
+ */
+long telemetrySinceReport(const telemetry_t *telemetry);
+
+/**
+ * @brief Prints the rates since the last report and the improvements that were not printed yet.
+ *
+ * @param telemetry The telemetry.
+ * @param myshm A pointer to the shared memory.
+ * @param best Size of the best solution so far.
+ * @param out The stream to print to.
+ */
+void telemetryReport(telemetry_t *telemetry, myshm_t *myshm, int best, FILE *out);
+
+/**
+ * @brief Frees the improvement log.
+ *
+ * @param telemetry The telemetry.
+ */
+void telemetryFree(telemetry_t *telemetry);
+
+#endif
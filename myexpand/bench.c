@@ -0,0 +1,317 @@
+/*
+ * @file bench.c
+ * @brief throughput benchmark and engine cross check for myexpand
+ * @author Vorobeva Aksinia 12044614
+ * @date 18.10.2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#define DEFAULT_SIZE_MB 32
+#define DEFAULT_REPETITIONS 3
+#define COMPARE_BLOCK (64 * 1024)
+
+/**
+ * @struct corpus_t
+ * @brief Parameters of a generated input corpus.
+ */
+typedef struct{
+	const char *name;		///< Name printed in the report.
+	int tab_percent;		///< Probability of a tab per character in percent.
+	int line_length;		///< Average line length in bytes.
+	int utf8_percent;		///< Probability of a multibyte UTF-8 character per character in percent.
+} corpus_t;
+
+static const corpus_t corpora[] = {
+	{"no-tabs", 0, 80, 0},
+	{"sparse-tabs", 1, 80, 0},
+	{"dense-tabs", 25, 40, 0},
+	{"short-lines", 10, 8, 0},
+	{"long-lines", 5, 100000, 0},
+	{"utf8", 5, 80, 20},
+};
+
+static const char *engines[] = {"byte", "block", "simd", "parallel"};
+
+#define CORPORA_AMOUNT ((int)(sizeof(corpora) / sizeof(corpora[0])))
+#define ENGINES_AMOUNT ((int)(sizeof(engines) / sizeof(engines[0])))
+
+char *prog_name;
+
+/**
+ * @brief Prints an error message and exits the program.
+ *
+ * @param msg The error message.
+ */
+void errorExit(const char *msg){
+	fprintf(stderr, "%s: %s\n", prog_name, msg);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Writes a corpus of the given size to a temporary file.
+ *
+ * @param corpus Parameters of the corpus.
+ * @param size Size of the corpus in bytes.
+ * @param path Buffer of at least 64 bytes that receives the path of the file.
+ */
+void generateCorpus(const corpus_t *corpus, size_t size, char *path){
+	static const char *utf8[] = {"\xc3\xa4", "\xc3\x9f", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+	strcpy(path, "/tmp/myexpand_bench_XXXXXX");
+	int fd = mkstemp(path);
+	if(fd == -1)
+		errorExit("mkstemp is failed");
+	FILE *file = fdopen(fd, "w");
+	if(file == NULL)
+		errorExit("fdopen is failed");
+	srand(42);
+	size_t written = 0;
+	int column = 0;
+	while(written < size){
+		int r = rand() % 100;
+		if(column >= corpus->line_length && rand() % 4 == 0){
+			fputc('\n', file);
+			written++;
+			column = 0;
+		}
+		else if(r < corpus->tab_percent){
+			fputc('\t', file);
+			written++;
+			column++;
+		}
+		else if(r < corpus->tab_percent + corpus->utf8_percent){
+			const char *c = utf8[rand() % 4];
+			fputs(c, file);
+			written += strlen(c);
+			column++;
+		}
+		else{
+			fputc("abcdefghijklmnopqrstuvwxyz ,.;"[rand() % 30], file);
+			written++;
+			column++;
+		}
+	}
+	fputc('\n', file);
+	if(fclose(file) == EOF)
+		errorExit("writing the corpus is failed");
+}
+
+/**
+ * @brief Returns the current monotonic time in seconds.
+ */
+double now(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Returns the time stamp counter, or 0 if it is not available.
+ */
+unsigned long long cycles(void){
+#ifdef HAVE_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+/**
+ * @brief Runs one engine on a corpus file.
+ *
+ * @details The program is started as a child process, so the measured time includes fork, exec,
+ * opening the files and the exit of the process, not only the expansion.
+ *
+ * @param myexpand Path of the myexpand binary.
+ * @param engine Name of the engine, or NULL to run coreutils expand.
+ * @param tabstop Tabstop passed to the program.
+ * @param input Path of the corpus.
+ * @param output Path of the output file.
+ * @param seconds Receives the wall clock time of the whole process.
+ * @param tsc Receives the time stamp counter cycles of the whole process.
+ * @return 0 if the program exited successfully, -1 otherwise.
+ */
+int runEngine(const char *myexpand, const char *engine, int tabstop, const char *input,
+		const char *output, double *seconds, unsigned long long *tsc){
+	char tab[16];
+	snprintf(tab, sizeof(tab), "%d", tabstop);
+	double start = now();
+	unsigned long long start_tsc = cycles();
+	pid_t pid = fork();
+	if(pid == -1)
+		errorExit("fork is failed");
+	if(pid == 0){
+		int in = open(input, O_RDONLY);
+		int out = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+		if(in == -1 || out == -1 || dup2(in, STDIN_FILENO) == -1 || dup2(out, STDOUT_FILENO) == -1)
+			_exit(127);
+		if(engine == NULL)
+			execlp("expand", "expand", "-t", tab, (char *) NULL);
+		else
+			execl(myexpand, myexpand, "-t", tab, "-e", engine, (char *) NULL);
+		_exit(127);
+	}
+	int status;
+	if(waitpid(pid, &status, 0) == -1)
+		errorExit("waitpid is failed");
+	*tsc = cycles() - start_tsc;
+	*seconds = now() - start;
+	return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Compares two files byte by byte.
+ *
+ * @return The offset of the first difference, or -1 if the files are equal.
+ */
+long compareFiles(const char *path1, const char *path2){
+	static char buf1[COMPARE_BLOCK];
+	static char buf2[COMPARE_BLOCK];
+	FILE *file1 = fopen(path1, "r");
+	FILE *file2 = fopen(path2, "r");
+	if(file1 == NULL || file2 == NULL)
+		errorExit("opening output for comparison is failed");
+	long offset = 0;
+	long diff = -1;
+	for(;;){
+		size_t len1 = fread(buf1, 1, sizeof(buf1), file1);
+		size_t len2 = fread(buf2, 1, sizeof(buf2), file2);
+		size_t len = len1 < len2 ? len1 : len2;
+		for(size_t i = 0; i < len; i++){
+			if(buf1[i] != buf2[i]){
+				diff = offset + (long) i;
+				break;
+			}
+		}
+		if(diff == -1 && len1 != len2)
+			diff = offset + (long) len;
+		if(diff != -1 || len1 == 0)
+			break;
+		offset += (long) len;
+	}
+	fclose(file1);
+	fclose(file2);
+	return diff;
+}
+
+/**
+ * @brief Generates corpora with different tab density, line length and UTF-8 content and runs every
+ * myexpand engine and coreutils expand on them.
+ *
+ * @details Reports GB/s and cycles per byte of the fastest of the repetitions. Every run is a separate
+ * process, so the numbers include fork and exec and are lower than the throughput of the expansion
+ * alone, most visibly for small corpora. With -c the outputs of all engines are compared against the
+ * byte engine instead; if the byte engine fails on a corpus, there is no reference and the other
+ * engines are not run on it.
+ *
+ * @param argc The argument counter.
+ * @param argv The argument vector.
+ * @return EXIT_SUCCESS if every engine ran and agreed, EXIT_FAILURE otherwise.
+ */
+int main(int argc, char *argv[]){
+	prog_name = argv[0];
+	const char *myexpand = "./myexpand";
+	int size_mb = DEFAULT_SIZE_MB;
+	int repetitions = DEFAULT_REPETITIONS;
+	int tabstop = 8;
+	int check = 0;
+	int opt;
+	while((opt = getopt(argc, argv, "s:r:t:m:c")) != -1){
+		switch(opt){
+			case 's': size_mb = atoi(optarg); break;
+			case 'r': repetitions = atoi(optarg); break;
+			case 't': tabstop = atoi(optarg); break;
+			case 'm': myexpand = optarg; break;
+			case 'c': check = 1; break;
+			default:
+				fprintf(stderr, "Usage: %s [-s MB] [-r repetitions] [-t tabstop] [-m myexpand] [-c]\n", prog_name);
+				return EXIT_FAILURE;
+		}
+	}
+	if(size_mb <= 0 || repetitions <= 0 || tabstop <= 0)
+		errorExit("arguments must be positive");
+
+	int failures = 0;
+	if(!check){
+		printf("times are per process and include fork and exec, not only the expansion\n");
+		printf("%-12s %-9s %10s %12s\n", "corpus", "engine", "GB/s", "cycles/byte");
+	}
+	for(int c = 0; c < CORPORA_AMOUNT; c++){
+		char input[64];
+		char reference[64];
+		char output[64];
+		size_t size = (size_t) size_mb * 1024 * 1024;
+		generateCorpus(&corpora[c], size, input);
+		strcpy(reference, "/tmp/myexpand_bench_ref_XXXXXX");
+		strcpy(output, "/tmp/myexpand_bench_out_XXXXXX");
+		int fd1 = mkstemp(reference);
+		int fd2 = mkstemp(output);
+		if(fd1 == -1 || fd2 == -1)
+			errorExit("mkstemp is failed");
+		close(fd1);
+		close(fd2);
+
+		for(int e = 0; e <= ENGINES_AMOUNT; e++){
+			const char *engine = e < ENGINES_AMOUNT ? engines[e] : NULL;
+			const char *name = engine != NULL ? engine : "expand";
+			const char *target = (check && e == 0) ? reference : (check ? output : "/dev/null");
+			double best = 0;
+			unsigned long long best_tsc = 0;
+			int runs = check ? 1 : repetitions;
+			int ok = 1;
+			for(int r = 0; r < runs; r++){
+				double seconds;
+				unsigned long long tsc;
+				if(runEngine(myexpand, engine, tabstop, input, target, &seconds, &tsc) == -1){
+					ok = 0;
+					break;
+				}
+				if(r == 0 || seconds < best){
+					best = seconds;
+					best_tsc = tsc;
+				}
+			}
+			if(!ok){
+				printf("%-12s %-9s %s\n", corpora[c].name, name,
+						check && e == 0 ? "failed to run, comparisons skipped" : "failed to run");
+				if(engine != NULL)
+					failures++;
+				if(check && e == 0)
+					break;
+				continue;
+			}
+			if(check){
+				if(e == 0)
+					continue;
+				long diff = compareFiles(reference, output);
+				if(diff == -1)
+					printf("%-12s %-9s ok\n", corpora[c].name, name);
+				else if(engine == NULL)
+					printf("%-12s %-9s differs at byte %ld (informational)\n", corpora[c].name, name, diff);
+				else{
+					printf("%-12s %-9s DIFFERS from byte at byte %ld\n", corpora[c].name, name, diff);
+					failures++;
+				}
+			}
+			else if(best_tsc != 0)
+				printf("%-12s %-9s %10.3f %12.3f\n", corpora[c].name, name, size / best / 1e9, (double) best_tsc / size);
+			else
+				printf("%-12s %-9s %10.3f %12s\n", corpora[c].name, name, size / best / 1e9, "n/a");
+		}
+		unlink(input);
+		unlink(reference);
+		unlink(output);
+	}
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
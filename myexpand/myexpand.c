@@ -6,9 +6,38 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <getopt.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #define DEFAULT_TABSTOP 8
 #define MAX_TABSTOP 64
+#define BLOCK_SIZE (64 * 1024)
+#define PARALLEL_BLOCK_SIZE (1024 * 1024)
+#define MAX_THREADS 64
+
+/**
+ * @brief Signature shared by all expansion engines.
+ */
+typedef void (*engine_t)(FILE *input, FILE *output, int tabstop);
+
+/**
+ * @struct segment_t
+ * @brief Part of an input block that is expanded by one thread of the parallel engine.
+ */
+typedef struct{
+	const char *in;			///< Start of the input segment.
+	size_t len;			///< Length of the input segment.
+	char *out;			///< Output buffer of the segment, kept for the next block.
+	size_t capacity;		///< Size of out.
+	size_t out_len;			///< Number of bytes written to out.
+	int tabstop;			///< Tabstop used for the expansion.
+	int position;			///< Position in the line at the start, position at the end afterwards.
+	int simd;			///< Non zero if the segment should be expanded with expandBufferSimd.
+} segment_t;
 
 /**
  * @brief Replace tabs with spaces in a text file.
@@ -42,6 +71,254 @@ void replaceTabsWithSpaces(FILE *input, FILE *output, int tabstop){
 			}	
 		}
 
+/**
+ * @brief Expands tabs of a buffer into an output buffer.
+ *
+ * @details Copies the runs between tab and newline characters with memcpy and only handles
+ * the tab and newline characters one by one. The output buffer must be able to hold
+ * len bytes plus tabstop - 1 bytes for every tab, at most len * tabstop bytes.
+ *
+ * @param in Input buffer.
+ * @param len Length of the input buffer.
+ * @param out Output buffer.
+ * @param tabstop Number of spaces equivalent to a tab character.
+ * @param position Position in the line, updated for the next buffer.
+ * @return The number of bytes written to out.
+ */
+size_t expandBuffer(const char *in, size_t len, char *out, int tabstop, int *position){
+	size_t written = 0;
+	size_t start = 0;
+	int pos = *position;
+	for(size_t i = 0; i < len; i++){
+		if(in[i] != '\t' && in[i] != '\n')
+			continue;
+		memcpy(out + written, in + start, i - start);
+		written += i - start;
+		pos += (int)(i - start);
+		if(in[i] == '\t'){
+			int spaces = tabstop - (pos % tabstop);
+			memset(out + written, ' ', spaces);
+			written += spaces;
+			pos += spaces;
+		}
+		else{
+			out[written++] = '\n';
+			pos = 0;
+		}
+		start = i + 1;
+	}
+	memcpy(out + written, in + start, len - start);
+	written += len - start;
+	*position = pos + (int)(len - start);
+	return written;
+}
+
+/**
+ * @brief Same as expandBuffer, but searches the next tab or newline 16 bytes at a time.
+ *
+ * @details Uses SSE2 compares on x86 and falls back to expandBuffer on other architectures.
+ *
+ * @param in Input buffer.
+ * @param len Length of the input buffer.
+ * @param out Output buffer.
+ * @param tabstop Number of spaces equivalent to a tab character.
+ * @param position Position in the line, updated for the next buffer.
+ * @return The number of bytes written to out.
+ */
+size_t expandBufferSimd(const char *in, size_t len, char *out, int tabstop, int *position){
+#ifdef __SSE2__
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i newline = _mm_set1_epi8('\n');
+	size_t written = 0;
+	size_t start = 0;
+	size_t i = 0;
+	int pos = *position;
+	while(i + 16 <= len){
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(in + i));
+		unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, tab),
+					_mm_cmpeq_epi8(chunk, newline)));
+		while(mask != 0){
+			size_t j = i + (size_t)__builtin_ctz(mask);
+			mask &= mask - 1;
+			memcpy(out + written, in + start, j - start);
+			written += j - start;
+			pos += (int)(j - start);
+			if(in[j] == '\t'){
+				int spaces = tabstop - (pos % tabstop);
+				memset(out + written, ' ', spaces);
+				written += spaces;
+				pos += spaces;
+			}
+			else{
+				out[written++] = '\n';
+				pos = 0;
+			}
+			start = j + 1;
+		}
+		i += 16;
+	}
+	pos += (int)(i - start);
+	memcpy(out + written, in + start, i - start);
+	written += i - start;
+	*position = pos;
+	return written + expandBuffer(in + i, len - i, out + written, tabstop, position);
+#else
+	return expandBuffer(in, len, out, tabstop, position);
+#endif
+}
+
+/**
+ * @brief Block engine: reads the input in blocks and expands them with expandBuffer.
+ *
+ * @param input  Pointer to the input file stream.
+ * @param output Pointer to the output file stream.
+ * @param tabstop Number of spaces equivalent to a tab character.
+ */
+void replaceTabsBlock(FILE *input, FILE *output, int tabstop){
+	static char in[BLOCK_SIZE];
+	static char out[BLOCK_SIZE * MAX_TABSTOP];
+	int position = 0;
+	size_t len;
+	while((len = fread(in, 1, sizeof(in), input)) > 0)
+		fwrite(out, 1, expandBuffer(in, len, out, tabstop, &position), output);
+}
+
+/**
+ * @brief SIMD engine: same as the block engine, but uses expandBufferSimd.
+ *
+ * @param input  Pointer to the input file stream.
+ * @param output Pointer to the output file stream.
+ * @param tabstop Number of spaces equivalent to a tab character.
+ */
+void replaceTabsSimd(FILE *input, FILE *output, int tabstop){
+	static char in[BLOCK_SIZE];
+	static char out[BLOCK_SIZE * MAX_TABSTOP];
+	int position = 0;
+	size_t len;
+	while((len = fread(in, 1, sizeof(in), input)) > 0)
+		fwrite(out, 1, expandBufferSimd(in, len, out, tabstop, &position), output);
+}
+
+/**
+ * @brief Thread function of the parallel engine, expands one segment.
+ *
+ * @details Counts the tabs of the segment first and grows its output buffer to the size the
+ * expansion needs, so the buffers only take as much memory as the output of the segments.
+ *
+ * @param arg Pointer to the segment_t to expand.
+ * @return NULL
+ */
+void *expandSegment(void *arg){
+	segment_t *segment = arg;
+	const char *end = segment->in + segment->len;
+	size_t tabs = 0;
+	for(const char *tab = segment->in; (tab = memchr(tab, '\t', (size_t)(end - tab))) != NULL; tab++)
+		tabs++;
+	size_t needed = segment->len + tabs * (size_t)(segment->tabstop - 1);
+	if(needed > segment->capacity){
+		char *out = realloc(segment->out, needed);
+		if(out == NULL){
+			fprintf(stderr, "myexpand: malloc is failed\n");
+			exit(EXIT_FAILURE);
+		}
+		segment->out = out;
+		segment->capacity = needed;
+	}
+	if(segment->simd)
+		segment->out_len = expandBufferSimd(segment->in, segment->len, segment->out, segment->tabstop, &segment->position);
+	else
+		segment->out_len = expandBuffer(segment->in, segment->len, segment->out, segment->tabstop, &segment->position);
+	return NULL;
+}
+
+/**
+ * @brief Parallel engine: splits each block at line boundaries and expands the parts in threads.
+ *
+ * @details Every segment except the first one starts right after a newline, so its position
+ * in the line is 0 and it does not depend on the other segments. The outputs are written in order.
+ * Every thread reads PARALLEL_BLOCK_SIZE bytes per block at tabstops up to DEFAULT_TABSTOP and
+ * proportionally less at larger tabstops, so a segment of tabs never needs more than
+ * PARALLEL_BLOCK_SIZE * DEFAULT_TABSTOP bytes of output.
+ *
+ * @param input  Pointer to the input file stream.
+ * @param output Pointer to the output file stream.
+ * @param tabstop Number of spaces equivalent to a tab character.
+ */
+void replaceTabsParallel(FILE *input, FILE *output, int tabstop){
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int threads = cpus < 1 ? 1 : (cpus > MAX_THREADS ? MAX_THREADS : (int) cpus);
+	size_t segment_size = (size_t) PARALLEL_BLOCK_SIZE * DEFAULT_TABSTOP
+		/ (size_t)(tabstop > DEFAULT_TABSTOP ? tabstop : DEFAULT_TABSTOP);
+	size_t block_size = segment_size * (size_t) threads;
+	char *in = malloc(block_size);
+	if(in == NULL){
+		fprintf(stderr, "myexpand: malloc is failed\n");
+		exit(EXIT_FAILURE);
+	}
+	segment_t segments[MAX_THREADS];
+	for(int i = 0; i < threads; i++){
+		segments[i].out = NULL;
+		segments[i].capacity = 0;
+	}
+	pthread_t tids[MAX_THREADS];
+	int started[MAX_THREADS];
+	int position = 0;
+	size_t len;
+	while((len = fread(in, 1, block_size, input)) > 0){
+		int count = 0;
+		size_t start = 0;
+		while(start < len && count < threads){
+			size_t end = (count == threads - 1) ? len : start + (len - start) / (size_t)(threads - count);
+			if(end <= start)
+				end = start + 1;
+			while(end < len && in[end - 1] != '\n')
+				end++;
+			segment_t *segment = &segments[count];
+			segment->in = in + start;
+			segment->len = end - start;
+			segment->tabstop = tabstop;
+			segment->position = count == 0 ? position : 0;
+			segment->simd = 1;
+			start = end;
+			count++;
+		}
+		for(int i = 1; i < count; i++){
+			started[i] = pthread_create(&tids[i], NULL, expandSegment, &segments[i]) == 0;
+			if(!started[i])
+				expandSegment(&segments[i]);
+		}
+		expandSegment(&segments[0]);
+		for(int i = 1; i < count; i++){
+			if(started[i])
+				pthread_join(tids[i], NULL);
+		}
+		for(int i = 0; i < count; i++)
+			fwrite(segments[i].out, 1, segments[i].out_len, output);
+		position = segments[count - 1].position;
+	}
+	free(in);
+	for(int i = 0; i < threads; i++)
+		free(segments[i].out);
+}
+
+/**
+ * @brief Looks up an engine by name.
+ *
+ * @param name Name of the engine (byte, block, simd or parallel).
+ * @return The engine, or NULL if the name is unknown.
+ */
+engine_t engineByName(const char *name){
+	if(strcmp(name, "byte") == 0)
+		return replaceTabsWithSpaces;
+	if(strcmp(name, "block") == 0)
+		return replaceTabsBlock;
+	if(strcmp(name, "simd") == 0)
+		return replaceTabsSimd;
+	if(strcmp(name, "parallel") == 0)
+		return replaceTabsParallel;
+	return NULL;
+}
+
 int main(int argc, char  *argv[]){
 	int tabstop = DEFAULT_TABSTOP;
 	char *outFilename = NULL;
@@ -49,10 +326,13 @@ int main(int argc, char  *argv[]){
 
 	FILE *output = stdout;
 
+	engine_t engine = replaceTabsSimd;
+
 	int count_t = 0;
 	int count_o = 0;
+	int count_e = 0;
 
-	while(((opt = getopt(argc, argv, ":t:o:")) != -1)){
+	while(((opt = getopt(argc, argv, ":t:o:e:")) != -1)){
 		switch(opt){
 			case 't':{
 					 char *ptr;
@@ -84,6 +364,19 @@ int main(int argc, char  *argv[]){
 					}
 					 break;
 				 }
+			case 'e':{
+					 engine = engineByName(optarg);
+					 if(engine == NULL){
+						 fprintf(stderr, "%s: Unknown engine '%s' (byte, block, simd, parallel).\n", argv[0], optarg);
+						 return EXIT_FAILURE;
+					 }
+					 if(count_e != 0){
+						 fprintf(stderr, "%s: More then one 'e'.\n", argv[0]);
+						 return EXIT_FAILURE;
+					 }
+					 count_e++;
+					 break;
+				 }
 			case ':': {
 					// Handle case where an option requires an argument.
 					fprintf(stderr, "%s: Option -%c requires an argument.\n", argv[0], optopt);
@@ -117,7 +410,7 @@ int main(int argc, char  *argv[]){
 		for(i = optind; i < argc; i++){
 			FILE *input = fopen(argv[i], "r");
 			if(input != NULL){
-				replaceTabsWithSpaces(input, output, tabstop);
+				engine(input, output, tabstop);
 				fclose(input);		
 			}
 			else{
@@ -127,7 +420,7 @@ int main(int argc, char  *argv[]){
 		}
 	} else {
 		// If no input files specified, replace tabs with spaces from standard input.
-		replaceTabsWithSpaces(stdin, output, tabstop);
+		engine(stdin, output, tabstop);
 	}
 
 	// Close the output file if it was opened.